@@ -39,20 +39,49 @@
 #define Yellow          0xFFE0      /* 255, 255, 0   */
 #define White           0xFFFF      /* 255, 255, 255 */
 
+/* SPI traffic counters, only updated when the driver is built with GLCD_STATS */
+typedef struct {
+  unsigned int bytes;                   /* Bytes sent over SSP1               */
+  unsigned int starts;                  /* Start bytes (one per transfer)     */
+  unsigned int cs;                      /* Chip select toggles                */
+} GLCD_STATS_T;
+
+extern GLCD_STATS_T GLCD_Stats;
+
+/* Source image of GLCD_BlitSub, the frames of a sprite sheet share one atlas */
+typedef struct {
+  const void           *pixels;         /* RGB565 colors, or palette indexes  */
+  const unsigned short *palette;        /* 8 bit index to color, 0 for RGB565 */
+  unsigned int          stride;         /* Pixels from one atlas row to next  */
+} GLCD_ATLAS_T;
+
+#define GLCD_OPAQUE     0x10000         /* GLCD_BlitSub key, nothing skipped  */
+
 extern void GLCD_Init           (void);
 extern void GLCD_WindowMax      (void);
 extern void GLCD_PutPixel       (unsigned int x, unsigned int y);
 extern void GLCD_SetTextColor   (unsigned short color);
 extern void GLCD_SetBackColor   (unsigned short color);
 extern void GLCD_Clear          (unsigned short color);
+extern void GLCD_ClearStart     (unsigned short color, void (*done)(void));
+extern int  GLCD_ClearStep      (unsigned int budget);
 extern void GLCD_DrawChar       (unsigned int x,  unsigned int y, unsigned int cw, unsigned int ch, unsigned char *c);
 extern void GLCD_DisplayChar    (unsigned int ln, unsigned int col, unsigned char fi, unsigned char  c);
 extern void GLCD_DisplayString  (unsigned int ln, unsigned int col, unsigned char fi, unsigned char *s);
 extern void GLCD_ClearLn        (unsigned int ln, unsigned char fi);
 extern void GLCD_Bargraph       (unsigned int x,  unsigned int y, unsigned int w, unsigned int h, unsigned int val);
 extern void GLCD_Bitmap         (unsigned int x,  unsigned int y, unsigned int w, unsigned int h, unsigned char *bitmap);
+extern void GLCD_BitmapRLE      (unsigned int x,  unsigned int y, const unsigned char *rle);
+extern void GLCD_BlitSub        (unsigned int x,  unsigned int y, const GLCD_ATLAS_T *atlas,
+                                 unsigned int sx, unsigned int sy, unsigned int w, unsigned int h, unsigned int key);
+extern void GLCD_WriteWindow    (unsigned int x,  unsigned int y, unsigned int w, unsigned int h, const unsigned short *data);
 extern void GLCD_ScrollVertical (unsigned int dy);
 
+extern void GLCD_SetCursor      (unsigned int x,  unsigned int y);
+extern void GLCD_SetVertical    (unsigned int on);
+extern void GLCD_WrDatStart     (void);
+extern void GLCD_WrDatOnly      (unsigned short dat);
+extern void GLCD_WrDatStop      (void);
 extern void GLCD_WrCmd          (unsigned char cmd);
 extern void GLCD_WrReg          (unsigned char reg, unsigned short val); 
 
@@ -12,6 +12,7 @@
 
 #include <lpc17xx.h>
 #include "GLCD.h"
+#include "target.h"
 #include "Font_6x8_h.h"
 #include "Font_16x24_h.h"
 
@@ -20,6 +21,56 @@
 #define LANDSCAPE   1                   /* 1 for landscape, 0 for portrait    */
 #define ROTATE180   0                   /* 1 to rotate the screen for 180 deg */
 
+/************************** Statistics configuration **************************/
+
+/* 1 to count the bytes, start bytes and chip select toggles sent to the LCD, 
+   the counters are used by the SPI cost model (spicost.c)                    */
+#ifndef GLCD_STATS
+#define GLCD_STATS  0
+#endif
+
+/*************************** Transfer configuration ***************************/
+
+/* 1 to send the pixel data of GRAM bursts as 16 bit SSP frames that are
+   queued in the TX FIFO, 0 to send them byte by byte like the commands       */
+#ifndef GLCD_SSP16
+#define GLCD_SSP16  1
+#endif
+
+/* 1 to queue the bytes of commands and register writes in the TX FIFO and
+   only wait for SSP1 before the chip select goes high, 0 to wait for every
+   byte to come back                                                          */
+#ifndef GLCD_FIFO
+#define GLCD_FIFO   1
+#endif
+
+/* Number of color expanded glyphs GLCD_DrawChar keeps in the AHB SRAM, up to
+   16x24 pixels (768 bytes) each, 0 to expand every glyph while it is sent    */
+#ifndef GLCD_GLYPH_CACHE
+#define GLCD_GLYPH_CACHE 4
+#endif
+
+/* 1 to send cached glyphs by GPDMA channel 0 while the CPU goes on, the
+   next access to the LCD waits for the end of the transfer. Needs the 16 bit
+   SSP frames of GLCD_SSP16                                                   */
+#ifndef GLCD_DMA
+#define GLCD_DMA    1
+#endif
+#if (GLCD_SSP16 == 0) || (GLCD_GLYPH_CACHE == 0)
+#undef  GLCD_DMA
+#define GLCD_DMA    0
+#endif
+
+/* LCD controller: GLCD_DETECT reads the controller ID in GLCD_Init and calls
+   the matching back end through a function table, GLCD_ILI932X or
+   GLCD_HX8347D build only that back end for a board with a known controller */
+#define GLCD_DETECT   0
+#define GLCD_ILI932X  1
+#define GLCD_HX8347D  2
+#ifndef GLCD_CONTROLLER
+#define GLCD_CONTROLLER GLCD_DETECT
+#endif
+
 /*********************** Hardware specific configuration **********************/
 
 /* SPI Interface: SPI3
@@ -41,14 +92,26 @@
 
 /* SPI_SR - bit definitions                                                   */
 #define TFE         0x01
+#define TNF         0x02
 #define RNE         0x04
 #define BSY         0x10
 
+/* SPI_CR0 - data size select, SPI_ICR - receive overrun clear                */
+#define DSS_MASK    0x0F
+#define DSS_8       0x07
+#define DSS_16      0x0F
+#define RORIC       0x01
+#define TXDMAE      0x02
+
+/* GPDMA channel 0 feeding SSP1: 16 bit transfers in bursts of 4, source
+   address increment, memory to peripheral on request line 2 (SSP1 Tx)       */
+#define DMA_CTRL    ((1 << 12) | (1 << 15) | (1 << 18) | (1 << 21) | (1 << 26))
+#define DMA_CONFIG  (0x01 | (2 << 6) | (1 << 11))
+
 /*------------------------- Speed dependant settings -------------------------*/
 
-/* If processor works on high frequency delay has to be increased, it can be 
-   increased by factor 2^N by this constant                                   */
-#define DELAY_2N    18
+/* The delays are timed by the DWT cycle counter (target.h) and follow        */
+/* SystemCoreClock, they need no tuning for the processor frequency           */
 
 /*---------------------- Graphic LCD size definitions ------------------------*/
 
@@ -64,14 +127,33 @@
 
 /*--------------- Graphic LCD interface hardware definitions -----------------*/
 
-/* Pin CS setting to 0 or 1                                                   */
-#define LCD_CS(x)   ((x) ? (LPC_GPIO0->FIOSET = PIN_CS)    : (LPC_GPIO0->FIOCLR = PIN_CS))
+#if (GLCD_STATS == 1)
+#define STAT_INC(f) (GLCD_Stats.f++)
+#else
+#define STAT_INC(f) ((void)0)
+#endif
+
+/* Pin CS setting to 0 or 1, a host build drives the LCD emulator instead    */
+#ifdef HOST_BUILD
+#define LCD_CS(x)   (STAT_INC(cs), host_lcdCs(x))
+#else
+#define LCD_CS(x)   (STAT_INC(cs), (x) ? (LPC_GPIO0->FIOSET = PIN_CS)    : (LPC_GPIO0->FIOCLR = PIN_CS))
+#endif
 #define LCD_CLK(x)  ((x) ? (LPC_GPIO0->FIOSET = PIN_CLK)   : (LPC_GPIO0->FIOCLR = PIN_CLK))
 #define LCD_DAT(x)  ((x) ? (LPC_GPIO0->FIOSET = PIN_DAT)   : (LPC_GPIO0->FIOCLR = PIN_DAT))
 
 #define DAT_MODE(x) ((x == OUT) ? (LPC_GPIO0->FIODIR |= PIN_DAT) : (LPC_GPIO0->FIODIR &= ~PIN_DAT))
 #define BUS_VAL()                ((LPC_GPIO0->FIOPIN  & PIN_DAT) != 0)
 
+/* SSP1 data register access                                                  */
+#ifdef HOST_BUILD
+#define SSP_TX(x)   host_sspTx(x)
+#define SSP_RX()    host_sspRx()
+#else
+#define SSP_TX(x)   (LPC_SSP1->DR = (x))
+#define SSP_RX()    (LPC_SSP1->DR)
+#endif
+
 
 #define SPI_START   (0x70)              /* Start byte for SPI transfer        */
 #define SPI_RD      (0x01)              /* WR bit 1 within start              */
@@ -87,19 +169,70 @@
 
 /******************************************************************************/
 static volatile unsigned short Color[2] = {White, Black};
-static unsigned char Himax;
+GLCD_STATS_T GLCD_Stats;
+
+/* Shadow copies of the window, cursor and entry mode registers as last sent,
+   SHADOW_NONE when the register value is not known. The cursor is in screen
+   coordinates and only kept by the ILI932x back end, it follows the GRAM
+   address counter as pixel data moves it through the window                  */
+#define SH_X_START  0
+#define SH_X_END    1
+#define SH_Y_START  2
+#define SH_Y_END    3
+#define SH_CUR_X    4
+#define SH_CUR_Y    5
+#define SH_ENTRY    6
+#define SH_COUNT    7
+#define SHADOW_NONE 0xFFFF
+
+static unsigned short Shadow[SH_COUNT];
+static unsigned int   Burst;            /* Pixels sent since wr_dat_start     */
+static unsigned char  Vertical;         /* Pixel data runs down the column    */
+
+static unsigned short ClearColor;       /* Color of the running step clear    */
+static unsigned int   ClearLeft;        /* Rows the step clear has to go      */
+static void         (*ClearDone)(void); /* Called when the last row is clear  */
+
+#if (GLCD_GLYPH_CACHE > 0)
+#define GLYPH_PIXELS (16*24)            /* Largest glyph, Font_16x24_h        */
+
+typedef struct {
+  const unsigned char *bitmap;          /* Font bitmap, 0 for a free entry    */
+  unsigned short       cw, ch;          /* Glyph width and height             */
+  unsigned short       fg, bg;          /* Colors it was expanded with        */
+  unsigned int         used;            /* GlyphClock at the last use         */
+  unsigned short       pixels[GLYPH_PIXELS];
+} GLYPH_T;
+
+static GLYPH_T      Glyph[GLCD_GLYPH_CACHE] AHBSRAM;
+static unsigned int GlyphClock;
+#endif
+
+#if (GLCD_DMA == 1)
+static unsigned char DmaBusy;           /* A glyph burst is still going out   */
+static void dma_finish (void);
+#define DMA_WAIT()  (DmaBusy ? dma_finish() : (void)0)
+#else
+#define DMA_WAIT()  ((void)0)
+#endif
 
 /************************ Local auxiliary functions ***************************/
 
 /*******************************************************************************
-* Delay in while loop cycles                                                   *
-*   Parameter:    cnt:    number of while cycles to delay                      *
+* Delay in microseconds, the host build does not wait                          *
+*   Parameter:    us:     number of microseconds to delay                      *
 *   Return:                                                                    *
 *******************************************************************************/
 
-static void delay (int cnt) {
-  cnt <<= DELAY_2N;
-  while (cnt--);
+static void delay_us (unsigned int us) {
+#ifndef HOST_BUILD
+  unsigned int start  = DWT_CYCCNT;
+  unsigned int cycles = SystemCoreClock / 1000000 * us;
+
+  while (DWT_CYCCNT - start < cycles);
+#else
+  (void)us;
+#endif
 }
 
 
@@ -109,6 +242,7 @@ static void delay (int cnt) {
 *                 mode:   OUT = transmit byte, IN = receive byte               *
 *   Return:               byte read while sending                              *
 *******************************************************************************/
+#if (GLCD_CONTROLLER == GLCD_DETECT)
 static unsigned char spi_tran_man (unsigned char byte, unsigned int mode) {
   unsigned char val = 0;
   int i;
@@ -118,7 +252,7 @@ static unsigned char spi_tran_man (unsigned char byte, unsigned int mode) {
 
   for (i = 7; i >= 0; i--) {
     LCD_CLK(0);
-    delay(1);
+    delay_us(1);
     if (mode == OUT) {
       LCD_DAT((byte & (1 << i)) != 0);
     }
@@ -126,10 +260,11 @@ static unsigned char spi_tran_man (unsigned char byte, unsigned int mode) {
       val |= (BUS_VAL() << i);
     }
     LCD_CLK(1);
-    delay(1);
+    delay_us(1);
   }
   return (val);
 }
+#endif
 
 
 /*******************************************************************************
@@ -140,9 +275,44 @@ static unsigned char spi_tran_man (unsigned char byte, unsigned int mode) {
 
 static __inline unsigned char spi_tran (unsigned char byte) {
 
-  LPC_SSP1->DR = byte;
+  STAT_INC(bytes);
+  SSP_TX(byte);
   while (!(LPC_SSP1->SR & RNE));        /* Wait for send to finish            */
-  return (LPC_SSP1->DR);
+  return (SSP_RX());
+}
+
+
+/*******************************************************************************
+* Queue 1 byte for sending without waiting for it, spi_flush has to be called  *
+* before the chip select goes high                                             *
+*   Parameter:    byte:   byte to be sent                                      *
+*   Return:                                                                    *
+*******************************************************************************/
+
+static __inline void spi_write (unsigned char byte) {
+
+#if (GLCD_FIFO == 1)
+  STAT_INC(bytes);
+  while (!(LPC_SSP1->SR & TNF));        /* Wait for room in the TX FIFO       */
+  SSP_TX(byte);
+#else
+  spi_tran(byte);
+#endif
+}
+
+
+/*******************************************************************************
+* Wait until all queued frames are sent and drop the frames clocked in         *
+*   Parameter:                                                                 *
+*   Return:                                                                    *
+*******************************************************************************/
+
+static __inline void spi_flush (void) {
+
+  while (LPC_SSP1->SR & BSY);           /* Wait for the last frame to go out  */
+  while (LPC_SSP1->SR & RNE)            /* Drop the frames clocked in         */
+    SSP_RX();
+  LPC_SSP1->ICR = RORIC;                /* The RX FIFO overran on long bursts */
 }
 
 
@@ -153,14 +323,53 @@ static __inline unsigned char spi_tran (unsigned char byte) {
 *******************************************************************************/
 
 static __inline void wr_cmd (unsigned char cmd) {
+  DMA_WAIT();
   LCD_CS(0);
-  spi_tran(SPI_START | SPI_WR | SPI_INDEX);   /* Write : RS = 0, RW = 0       */
-  spi_tran(0);
-  spi_tran(cmd);
+  STAT_INC(starts);
+  spi_write(SPI_START | SPI_WR | SPI_INDEX);  /* Write : RS = 0, RW = 0       */
+  spi_write(0);
+  spi_write(cmd);
+  spi_flush();
   LCD_CS(1);
 }
 
 
+/*******************************************************************************
+* Move the cursor copy the way the GRAM address counter moves for n pixels:    *
+* along the row (down the column when Vertical), then to the start of the      *
+* next row (column), then back to the start of the window. The copy is         *
+* dropped when the cursor was outside the window                               *
+*   Parameter:    n:      number of pixels written                             *
+*   Return:                                                                    *
+*******************************************************************************/
+
+static void cursor_advance (unsigned int n) {
+  unsigned int x  = Shadow[SH_CUR_X],   y  = Shadow[SH_CUR_Y];
+  unsigned int xs = Shadow[SH_X_START], xe = Shadow[SH_X_END];
+  unsigned int ys = Shadow[SH_Y_START], ye = Shadow[SH_Y_END];
+
+  if (n == 0)                           /* The counter has not moved          */
+    return;
+  if (x != SHADOW_NONE && y != SHADOW_NONE &&
+      x >= xs && x <= xe && y >= ys && y <= ye) {
+    if (Vertical) {
+      n += y - ys;
+      Shadow[SH_CUR_Y] = ys + n % (ye - ys + 1);
+      Shadow[SH_CUR_X] = xs + (x - xs + n / (ye - ys + 1)) % (xe - xs + 1);
+    }
+    else {
+      n += x - xs;
+      Shadow[SH_CUR_X] = xs + n % (xe - xs + 1);
+      Shadow[SH_CUR_Y] = ys + (y - ys + n / (xe - xs + 1)) % (ye - ys + 1);
+    }
+  }
+  else {
+    Shadow[SH_CUR_X] = SHADOW_NONE;
+    Shadow[SH_CUR_Y] = SHADOW_NONE;
+  }
+}
+
+
 /*******************************************************************************
 * Write data to the LCD controller                                             *
 *   Parameter:    dat:    data to be written                                   *
@@ -168,10 +377,13 @@ static __inline void wr_cmd (unsigned char cmd) {
 *******************************************************************************/
 
 static __inline void wr_dat (unsigned short dat) {
+  DMA_WAIT();
   LCD_CS(0);
-  spi_tran(SPI_START | SPI_WR | SPI_DATA);    /* Write : RS = 1, RW = 0       */
-  spi_tran((dat >>   8));                     /* Write D8..D15                */
-  spi_tran((dat & 0xFF));                     /* Write D0..D7                 */
+  STAT_INC(starts);
+  spi_write(SPI_START | SPI_WR | SPI_DATA);   /* Write : RS = 1, RW = 0       */
+  spi_write((dat >>   8));                    /* Write D8..D15                */
+  spi_write((dat & 0xFF));                    /* Write D0..D7                 */
+  spi_flush();
   LCD_CS(1);
 }
 
@@ -183,8 +395,16 @@ static __inline void wr_dat (unsigned short dat) {
 *******************************************************************************/
 
 static __inline void wr_dat_start (void) {
+  DMA_WAIT();
   LCD_CS(0);
-  spi_tran(SPI_START | SPI_WR | SPI_DATA);    /* Write : RS = 1, RW = 0       */
+  STAT_INC(starts);
+  Burst = 0;
+  spi_write(SPI_START | SPI_WR | SPI_DATA);   /* Write : RS = 1, RW = 0       */
+#if (GLCD_SSP16 == 1)
+  /* the data size may only change while SSP1 is idle                         */
+  spi_flush();
+  LPC_SSP1->CR0 = (LPC_SSP1->CR0 & ~DSS_MASK) | DSS_16;
+#endif
 }
 
 
@@ -196,6 +416,11 @@ static __inline void wr_dat_start (void) {
 
 static __inline void wr_dat_stop (void) {
 
+  cursor_advance(Burst);
+  spi_flush();
+#if (GLCD_SSP16 == 1)
+  LPC_SSP1->CR0 = (LPC_SSP1->CR0 & ~DSS_MASK) | DSS_8;
+#endif
   LCD_CS(1);
 }
 
@@ -208,11 +433,139 @@ static __inline void wr_dat_stop (void) {
 
 static __inline void wr_dat_only (unsigned short dat) {
 
-  spi_tran((dat >>   8));                     /* Write D8..D15                */
-  spi_tran((dat & 0xFF));                     /* Write D0..D7                 */
+  Burst++;
+#if (GLCD_SSP16 == 1)
+  STAT_INC(bytes);
+  STAT_INC(bytes);
+  while (!(LPC_SSP1->SR & TNF));        /* Wait for room in the TX FIFO       */
+  SSP_TX(dat);                          /* Write D15..D0, nothing read back   */
+#else
+  spi_write((dat >>   8));                    /* Write D8..D15                */
+  spi_write((dat & 0xFF));                    /* Write D0..D7                 */
+#endif
+}
+
+
+#if (GLCD_DMA == 1)
+/*******************************************************************************
+* Send pixel data by GPDMA within a burst started by wr_dat_start, the burst   *
+* is ended by dma_finish on the next access to the LCD                         *
+*   Parameter:    src:    pixel data, has to stay unchanged until dma_finish   *
+*                 n:      number of pixels, at most 4095                       *
+*   Return:                                                                    *
+*******************************************************************************/
+
+static void dma_send (const unsigned short *src, unsigned int n) {
+
+  /* Move the cursor copy now, the window may be rewritten before the wait    */
+  cursor_advance(Burst + n);
+  Burst   = 0;
+  DmaBusy = 1;
+#if (GLCD_STATS == 1)
+  GLCD_Stats.bytes += 2*n;
+#endif
+#ifdef HOST_BUILD
+  while (n--)                           /* No GPDMA, the LCD emulator takes   */
+    SSP_TX(*src++);                     /* the frames at once                 */
+#else
+  LPC_GPDMA->DMACIntTCClear   = 0x01;
+  LPC_GPDMA->DMACIntErrClr    = 0x01;
+  LPC_GPDMACH0->DMACCSrcAddr  = (uint32_t)src;
+  LPC_GPDMACH0->DMACCDestAddr = (uint32_t)&LPC_SSP1->DR;
+  LPC_GPDMACH0->DMACCLLI      = 0;
+  LPC_GPDMACH0->DMACCControl  = n | DMA_CTRL;
+  LPC_SSP1->DMACR             = TXDMAE;
+  LPC_GPDMACH0->DMACCConfig   = DMA_CONFIG;
+#endif
+}
+
+
+/*******************************************************************************
+* Wait for the GPDMA transfer of dma_send and end its burst                    *
+*   Parameter:                                                                 *
+*   Return:                                                                    *
+*******************************************************************************/
+
+static void dma_finish (void) {
+
+#ifndef HOST_BUILD
+  while (LPC_GPDMA->DMACEnbldChns & 0x01);  /* Channel 0 stops when done      */
+  LPC_SSP1->DMACR = 0;
+#endif
+  DmaBusy = 0;
+  wr_dat_stop();
+}
+#endif
+
+
+#if (GLCD_GLYPH_CACHE > 0)
+/*******************************************************************************
+* Empty the glyph cache, waits for a glyph burst still going out               *
+*   Parameter:                                                                 *
+*   Return:                                                                    *
+*******************************************************************************/
+
+static void glyph_reset (void) {
+  GLYPH_T *g;
+
+  DMA_WAIT();
+  for (g = &Glyph[0]; g < &Glyph[GLCD_GLYPH_CACHE]; g++) {
+    g->bitmap = 0;
+    g->used   = 0;
+  }
+  GlyphClock = 0;
 }
 
 
+/*******************************************************************************
+* Find a glyph in the glyph cache, or expand it with the current text and      *
+* background color into the least recently used entry                          *
+*   Parameter:    c:      glyph bitmap, one row after the other LSB first      *
+*                 cw:     glyph width in pixels, at most 16                    *
+*                 ch:     glyph height in pixels, cw*ch at most GLYPH_PIXELS   *
+*   Return:               cache entry holding the glyph                        *
+*******************************************************************************/
+
+static GLYPH_T *glyph_get (const unsigned char *c, unsigned int cw, unsigned int ch) {
+  unsigned short fg = Color[TXT_COLOR], bg = Color[BG_COLOR];
+  unsigned short *p;
+  GLYPH_T *g, *lru = &Glyph[0];
+  unsigned int i, j, pixs;
+
+  for (g = &Glyph[0]; g < &Glyph[GLCD_GLYPH_CACHE]; g++) {
+    if (g->bitmap == c && g->cw == cw && g->ch == ch && g->fg == fg && g->bg == bg) {
+      g->used = ++GlyphClock;
+      return (g);
+    }
+    if (g->used < lru->used)
+      lru = g;
+  }
+
+  g = lru;
+  g->bitmap = c;
+  g->cw     = cw;
+  g->ch     = ch;
+  g->fg     = fg;
+  g->bg     = bg;
+  g->used   = ++GlyphClock;
+  p = g->pixels;
+  for (j = 0; j < ch; j++) {
+    if (cw > 8) {
+      pixs = *(unsigned short *)c;
+      c += 2;
+    }
+    else {
+      pixs = *c;
+      c += 1;
+    }
+    for (i = 0; i < cw; i++)
+      *p++ = ((pixs >> i) & 1) ? fg : bg;
+  }
+  return (g);
+}
+#endif
+
+
 /*******************************************************************************
 * Read data from the LCD controller                                            *
 *   Parameter:                                                                 *
@@ -223,6 +576,7 @@ static __inline unsigned short rd_dat (void) {
   unsigned short val = 0;
 
   LCD_CS(0);
+  STAT_INC(starts);
   spi_tran(SPI_START | SPI_RD | SPI_DATA);    /* Read: RS = 1, RW = 1         */
   spi_tran(0);                                /* Dummy read 1                 */  
   val   = spi_tran(0);                        /* Read D8..D15                 */
@@ -252,11 +606,13 @@ static __inline void wr_reg (unsigned char reg, unsigned short val) {
 *   Return:               value read from the register                         *
 *******************************************************************************/
 
+#if (GLCD_CONTROLLER != GLCD_HX8347D)
 static unsigned short rd_reg (unsigned char reg) {
 
   wr_cmd(reg);
   return(rd_dat());
 }
+#endif
 
 
 /*******************************************************************************
@@ -265,6 +621,7 @@ static unsigned short rd_reg (unsigned char reg) {
 *   Return:       controller ID                                                *
 *******************************************************************************/
 
+#if (GLCD_CONTROLLER == GLCD_DETECT)
 static unsigned short rd_id_man (void) {
   unsigned short val;
 
@@ -292,6 +649,431 @@ static unsigned short rd_id_man (void) {
 
   return (val);
 }
+#endif
+
+/************************ Controller back ends ********************************/
+
+/* The window, cursor and scroll sequences of each controller, GLCD_Init picks
+   the back end once (GLCD_CONTROLLER == GLCD_DETECT) or the build fixes it
+   and the exported functions call it directly through LCD_OP. Both back ends
+   write the window and cursor registers through the shadow copies           */
+
+typedef struct {
+  void (*set_window) (unsigned int x, unsigned int y, unsigned int w, unsigned int h);
+  void (*set_cursor) (unsigned int x, unsigned int y);
+  void (*put_pixel)  (unsigned int x, unsigned int y, unsigned short color);
+  void (*set_vertical) (unsigned int on);
+  void (*scroll)     (unsigned int y);
+} LCD_BACKEND_T;
+
+
+/*******************************************************************************
+* Write a window, cursor or entry mode register through its shadow copy, the   *
+* register is only sent when the value differs from the one sent last          *
+*   Parameter:    i:      index of the shadow copy                             *
+*                 reg:    register address                                     *
+*                 val:    value to be written                                  *
+*   Return:                                                                    *
+*******************************************************************************/
+
+static __inline void wr_reg_shadow (unsigned int i, unsigned char reg, unsigned short val) {
+
+  if (Shadow[i] != val) {
+    Shadow[i] = val;
+    wr_reg(reg, val);
+  }
+}
+
+
+/*******************************************************************************
+* Forget the shadow copies, the registers are written again on the next use    *
+*   Parameter:                                                                 *
+*   Return:                                                                    *
+*******************************************************************************/
+
+static void shadow_reset (void) {
+  unsigned int i;
+
+  for (i = 0; i < SH_COUNT; i++)
+    Shadow[i] = SHADOW_NONE;
+}
+
+
+#if (GLCD_CONTROLLER != GLCD_HX8347D)
+/*******************************************************************************
+* ILI932x: the window is R50..R53, the GRAM address counter is R20/R21 and     *
+* moves on after every pixel written in the direction selected by the AM bit   *
+* of the entry mode register R03                                               *
+*******************************************************************************/
+
+#if (LANDSCAPE == 1)
+#define ILI_X_START 0x52                /* Vertical   GRAM Start Address      */
+#define ILI_X_END   0x53                /* Vertical   GRAM End   Address (-1) */
+#define ILI_Y_START 0x50                /* Horizontal GRAM Start Address      */
+#define ILI_Y_END   0x51                /* Horizontal GRAM End   Address (-1) */
+#define ILI_CUR_X   0x21
+#define ILI_CUR_Y   0x20
+#define ILI_ENTRY_H 0x1038              /* AM=1, along the screen row         */
+#define ILI_ENTRY_V 0x1030              /* AM=0, down the screen column       */
+#else
+#define ILI_X_START 0x50                /* Horizontal GRAM Start Address      */
+#define ILI_X_END   0x51                /* Horizontal GRAM End   Address (-1) */
+#define ILI_Y_START 0x52                /* Vertical   GRAM Start Address      */
+#define ILI_Y_END   0x53                /* Vertical   GRAM End   Address (-1) */
+#define ILI_CUR_X   0x20
+#define ILI_CUR_Y   0x21
+#define ILI_ENTRY_H 0x1030              /* AM=0, along the screen row         */
+#define ILI_ENTRY_V 0x1038              /* AM=1, down the screen column       */
+#endif
+
+static void ili_set_cursor (unsigned int x, unsigned int y) {
+
+  wr_reg_shadow(SH_CUR_Y, ILI_CUR_Y, y);
+  wr_reg_shadow(SH_CUR_X, ILI_CUR_X, x);
+}
+
+static void ili_set_window (unsigned int x, unsigned int y, unsigned int w, unsigned int h) {
+
+  wr_reg_shadow(SH_Y_START, ILI_Y_START, y);
+  wr_reg_shadow(SH_Y_END,   ILI_Y_END,   y+h-1);
+  wr_reg_shadow(SH_X_START, ILI_X_START, x);
+  wr_reg_shadow(SH_X_END,   ILI_X_END,   x+w-1);
+  ili_set_cursor(x, y);
+}
+
+static void ili_put_pixel (unsigned int x, unsigned int y, unsigned short color) {
+
+  ili_set_cursor(x, y);
+  wr_cmd(0x22);
+  wr_dat(color);
+  cursor_advance(1);
+}
+
+static void ili_set_vertical (unsigned int on) {
+
+  wr_reg_shadow(SH_ENTRY, 0x03, on ? ILI_ENTRY_V : ILI_ENTRY_H);
+}
+
+#if (LANDSCAPE == 0) || (GLCD_CONTROLLER == GLCD_DETECT)
+static void ili_scroll (unsigned int y) {
+
+  wr_reg(0x6A, y);
+  wr_reg(0x61, 3);
+}
+#endif
+#endif
+
+#if (GLCD_CONTROLLER != GLCD_ILI932X)
+/*******************************************************************************
+* HX8347-D: the window is the column and row start and end address, each in a  *
+* MSB and a LSB register, GRAM writes begin at the start address. The shadow   *
+* copies hold the whole address, the MSB and the LSB register are each only    *
+* written when their half changes. Column runs use a one pixel wide window     *
+* from the cursor down to the bottom of the screen                             *
+*******************************************************************************/
+
+static __inline void hx_wr_addr (unsigned int i, unsigned char reg, unsigned int val) {
+  unsigned int old = Shadow[i];
+
+  Shadow[i] = val;
+  if (old == SHADOW_NONE || (old >> 8) != (val >> 8))
+    wr_reg(reg,   val >> 8);            /* Address MSB                        */
+  if (old == SHADOW_NONE || (old & 0xFF) != (val & 0xFF))
+    wr_reg(reg+1, val & 0xFF);          /* Address LSB                        */
+}
+
+static void hx_set_window (unsigned int x, unsigned int y, unsigned int w, unsigned int h) {
+
+  hx_wr_addr(SH_X_START, 0x02, x);      /* Column address start               */
+  hx_wr_addr(SH_X_END,   0x04, x+w-1);  /* Column address end                 */
+  hx_wr_addr(SH_Y_START, 0x06, y);      /* Row address start                  */
+  hx_wr_addr(SH_Y_END,   0x08, y+h-1);  /* Row address end                    */
+}
+
+static void hx_set_cursor (unsigned int x, unsigned int y) {
+
+  if (Vertical) {
+    hx_set_window(x, y, 1, HEIGHT-y);
+    return;
+  }
+  hx_wr_addr(SH_X_START, 0x02, x);      /* Column address start               */
+  hx_wr_addr(SH_Y_START, 0x06, y);      /* Row address start                  */
+}
+
+static void hx_put_pixel (unsigned int x, unsigned int y, unsigned short color) {
+
+  hx_set_window(x, y, 1, 1);
+  wr_cmd(0x22);
+  wr_dat(color);
+}
+
+static void hx_set_vertical (unsigned int on) {
+
+  if (!on)
+    hx_set_window(0, 0, WIDTH, HEIGHT); /* Back from the column window        */
+}
+
+#if (LANDSCAPE == 0) || (GLCD_CONTROLLER == GLCD_DETECT)
+static void hx_scroll (unsigned int y) {
+
+  wr_reg(0x01, 0x08);
+  wr_reg(0x14, y>>8);                   /* VSP MSB                            */
+  wr_reg(0x15, y&0xFF);                 /* VSP LSB                            */
+}
+#endif
+#endif
+
+
+#if (GLCD_CONTROLLER == GLCD_DETECT)
+static const LCD_BACKEND_T ili_backend = {
+  ili_set_window, ili_set_cursor, ili_put_pixel, ili_set_vertical, ili_scroll
+};
+
+static const LCD_BACKEND_T hx_backend = {
+  hx_set_window, hx_set_cursor, hx_put_pixel, hx_set_vertical, hx_scroll
+};
+
+static const LCD_BACKEND_T *Backend = &ili_backend;
+#define LCD_OP(f)       (Backend->f)
+#define LCD_SELECT(b)   (Backend = &b##_backend)
+#elif (GLCD_CONTROLLER == GLCD_HX8347D)
+#define LCD_OP(f)       hx_##f
+#define LCD_SELECT(b)   ((void)0)
+#else
+#define LCD_OP(f)       ili_##f
+#define LCD_SELECT(b)   ((void)0)
+#endif
+
+
+/************************ Init sequences **************************************/
+
+/*******************************************************************************
+* Register writes of the controller start up, applied in order by wr_table.    *
+* ms is the time the controller needs after the write before the next one      *
+*******************************************************************************/
+
+typedef struct {
+  unsigned char  reg;                   /* Register index                     */
+  unsigned short val;                   /* Value written to the register      */
+  unsigned char  ms;                    /* Delay after the write in ms        */
+} LCD_INIT_T;
+
+#define WR_TABLE(t) wr_table((t), sizeof(t) / sizeof((t)[0]))
+
+static const LCD_INIT_T hx_init[] = {
+  /* Driving ability settings ------------------------------------------------*/
+  { 0xEA, 0x00,   0 },                  /* Power control internal used (1)    */
+  { 0xEB, 0x20,   0 },                  /* Power control internal used (2)    */
+  { 0xEC, 0x0C,   0 },                  /* Source control internal used (1)   */
+  { 0xED, 0xC7,   0 },                  /* Source control internal used (2)   */
+  { 0xE8, 0x38,   0 },                  /* Source output period Normal mode   */
+  { 0xE9, 0x10,   0 },                  /* Source output period Idle mode     */
+  { 0xF1, 0x01,   0 },                  /* RGB 18-bit interface ;0x0110       */
+  { 0xF2, 0x10,   0 },
+
+  /* Adjust the Gamma Curve --------------------------------------------------*/
+  { 0x40, 0x01,   0 },
+  { 0x41, 0x00,   0 },
+  { 0x42, 0x00,   0 },
+  { 0x43, 0x10,   0 },
+  { 0x44, 0x0E,   0 },
+  { 0x45, 0x24,   0 },
+  { 0x46, 0x04,   0 },
+  { 0x47, 0x50,   0 },
+  { 0x48, 0x02,   0 },
+  { 0x49, 0x13,   0 },
+  { 0x4A, 0x19,   0 },
+  { 0x4B, 0x19,   0 },
+  { 0x4C, 0x16,   0 },
+
+  { 0x50, 0x1B,   0 },
+  { 0x51, 0x31,   0 },
+  { 0x52, 0x2F,   0 },
+  { 0x53, 0x3F,   0 },
+  { 0x54, 0x3F,   0 },
+  { 0x55, 0x3E,   0 },
+  { 0x56, 0x2F,   0 },
+  { 0x57, 0x7B,   0 },
+  { 0x58, 0x09,   0 },
+  { 0x59, 0x06,   0 },
+  { 0x5A, 0x06,   0 },
+  { 0x5B, 0x0C,   0 },
+  { 0x5C, 0x1D,   0 },
+  { 0x5D, 0xCC,   0 },
+
+  /* Power voltage setting ---------------------------------------------------*/
+  { 0x1B, 0x1B,   0 },
+  { 0x1A, 0x01,   0 },
+  { 0x24, 0x2F,   0 },
+  { 0x25, 0x57,   0 },
+  { 0x23, 0x88,   0 },
+
+  /* Power on setting --------------------------------------------------------*/
+  { 0x18, 0x36,   0 },                  /* Internal oscillator frequency adj  */
+  { 0x19, 0x01,   0 },                  /* Enable internal oscillator         */
+  { 0x01, 0x00,   0 },                  /* Normal mode, no scrool             */
+  { 0x1F, 0x88, 200 },                  /* Power control 6 - DDVDH Off        */
+  { 0x1F, 0x82,  50 },                  /* Power control 6 - Step-up: 3 x VCI */
+  { 0x1F, 0x92,  50 },                  /* Power control 6 - Step-up: On      */
+  { 0x1F, 0xD2,  50 },                  /* Power control 6 - VCOML active     */
+
+  /* Color selection ---------------------------------------------------------*/
+  { 0x17, 0x55,   0 },                  /* RGB, System interface: 16 Bit/Pixel*/
+  { 0x00, 0x00,   0 },                  /* Scrolling off, no standby          */
+
+  /* Interface config --------------------------------------------------------*/
+  { 0x2F, 0x11,   0 },                  /* LCD Drive: 1-line inversion        */
+  { 0x31, 0x00,   0 },
+  { 0x32, 0x00,   0 },                  /* DPL=0, HSPL=0, VSPL=0, EPL=0       */
+
+  /* Display on setting ------------------------------------------------------*/
+  { 0x28, 0x38, 200 },                  /* PT(0,0) active, VGL/VGL            */
+  { 0x28, 0x3C,   0 },                  /* Display active, VGL/VGL            */
+
+ #if (LANDSCAPE == 1)
+  #if (ROTATE180 == 0)
+  { 0x16, 0xA8,   0 },
+  #else
+  { 0x16, 0x68,   0 },
+  #endif
+ #else
+  #if (ROTATE180 == 0)
+  { 0x16, 0x08,   0 },
+  #else
+  { 0x16, 0xC8,   0 },
+  #endif
+ #endif
+
+  /* Display scrolling settings ----------------------------------------------*/
+  { 0x0E, 0x00,   0 },                  /* TFA MSB                            */
+  { 0x0F, 0x00,   0 },                  /* TFA LSB                            */
+  { 0x10, 320 >> 8,   0 },              /* VSA MSB                            */
+  { 0x11, 320 &  0xFF, 0 },             /* VSA LSB                            */
+  { 0x12, 0x00,   0 },                  /* BFA MSB                            */
+  { 0x13, 0x00,   0 },                  /* BFA LSB                            */
+};
+
+static const LCD_INIT_T ili_init[] = {
+  /* Start Initial Sequence --------------------------------------------------*/
+ #if (ROTATE180 == 1)
+  { 0x01, 0x0000,   0 },                /* Clear SS bit                       */
+ #else
+  { 0x01, 0x0100,   0 },                /* Set SS bit                         */
+ #endif
+  { 0x02, 0x0700,   0 },                /* Set 1 line inversion               */
+  { 0x04, 0x0000,   0 },                /* Resize register                    */
+  { 0x08, 0x0207,   0 },                /* 2 lines front, 7 back porch        */
+  { 0x09, 0x0000,   0 },                /* Set non-disp area refresh cyc ISC  */
+  { 0x0A, 0x0000,   0 },                /* FMARK function                     */
+  { 0x0C, 0x0000,   0 },                /* RGB interface setting              */
+  { 0x0D, 0x0000,   0 },                /* Frame marker Position              */
+  { 0x0F, 0x0000,   0 },                /* RGB interface polarity             */
+
+  /* Power On sequence -------------------------------------------------------*/
+  { 0x10, 0x0000,   0 },                /* Reset Power Control 1              */
+  { 0x11, 0x0000,   0 },                /* Reset Power Control 2              */
+  { 0x12, 0x0000,   0 },                /* Reset Power Control 3              */
+  { 0x13, 0x0000, 200 },                /* Reset Power Control 4, discharge   */
+  { 0x10, 0x12B0,   0 },                /* SAP, BT[3:0], AP, DSTB, SLP, STB   */
+  { 0x11, 0x0007,  50 },                /* DC1[2:0], DC0[2:0], VC[2:0]        */
+  { 0x12, 0x01BD,  50 },                /* VREG1OUT voltage                   */
+  { 0x13, 0x1400,   0 },                /* VDV[4:0] for VCOM amplitude        */
+  { 0x29, 0x000E,  50 },                /* VCM[4:0] for VCOMH                 */
+  { 0x20, 0x0000,   0 },                /* GRAM horizontal Address            */
+  { 0x21, 0x0000,   0 },                /* GRAM Vertical Address              */
+};
+
+/* Gamma curve of the SPFD5408, the RM68050 and the ILI9320 or other          */
+static const LCD_INIT_T ili_gamma_5408[] = {
+  { 0x30, 0x0B0D,   0 },
+  { 0x31, 0x1923,   0 },
+  { 0x32, 0x1C26,   0 },
+  { 0x33, 0x261C,   0 },
+  { 0x34, 0x2419,   0 },
+  { 0x35, 0x0D0B,   0 },
+  { 0x36, 0x1006,   0 },
+  { 0x37, 0x0610,   0 },
+  { 0x38, 0x0706,   0 },
+  { 0x39, 0x0304,   0 },
+  { 0x3A, 0x0E05,   0 },
+  { 0x3B, 0x0E01,   0 },
+  { 0x3C, 0x010E,   0 },
+  { 0x3D, 0x050E,   0 },
+  { 0x3E, 0x0403,   0 },
+  { 0x3F, 0x0607,   0 },
+};
+
+static const LCD_INIT_T ili_gamma_9325[] = {
+  { 0x30, 0x0000,   0 },
+  { 0x31, 0x0607,   0 },
+  { 0x32, 0x0305,   0 },
+  { 0x35, 0x0000,   0 },
+  { 0x36, 0x1604,   0 },
+  { 0x37, 0x0204,   0 },
+  { 0x38, 0x0001,   0 },
+  { 0x39, 0x0707,   0 },
+  { 0x3C, 0x0000,   0 },
+  { 0x3D, 0x000F,   0 },
+};
+
+static const LCD_INIT_T ili_gamma_9320[] = {
+  { 0x30, 0x0006,   0 },
+  { 0x31, 0x0101,   0 },
+  { 0x32, 0x0003,   0 },
+  { 0x35, 0x0106,   0 },
+  { 0x36, 0x0B02,   0 },
+  { 0x37, 0x0302,   0 },
+  { 0x38, 0x0707,   0 },
+  { 0x39, 0x0007,   0 },
+  { 0x3C, 0x0600,   0 },
+  { 0x3D, 0x020B,   0 },
+};
+
+static const LCD_INIT_T ili_area[] = {
+  /* Set GRAM area -----------------------------------------------------------*/
+  { 0x50, 0x0000,   0 },                /* Horizontal GRAM Start Address      */
+  { 0x51, HEIGHT-1, 0 },                /* Horizontal GRAM End   Address      */
+  { 0x52, 0x0000,   0 },                /* Vertical   GRAM Start Address      */
+  { 0x53, WIDTH-1,  0 },                /* Vertical   GRAM End   Address      */
+};
+
+static const LCD_INIT_T ili_panel[] = {
+  { 0x61, 0x0001,   0 },                /* NDL,VLE, REV                       */
+  { 0x6A, 0x0000,   0 },                /* Set scrolling line                 */
+
+  /* Partial Display Control -------------------------------------------------*/
+  { 0x80, 0x0000,   0 },
+  { 0x81, 0x0000,   0 },
+  { 0x82, 0x0000,   0 },
+  { 0x83, 0x0000,   0 },
+  { 0x84, 0x0000,   0 },
+  { 0x85, 0x0000,   0 },
+
+  /* Panel Control -----------------------------------------------------------*/
+  { 0x90, 0x0010,   0 },
+  { 0x92, 0x0000,   0 },
+  { 0x93, 0x0003,   0 },
+  { 0x95, 0x0110,   0 },
+  { 0x97, 0x0000,   0 },
+  { 0x98, 0x0000,   0 },
+};
+
+
+/*******************************************************************************
+* Write a table of registers to the LCD controller                             *
+*   Parameter:    t:      first register write                                 *
+*                 n:      number of register writes                            *
+*   Return:                                                                    *
+*******************************************************************************/
+
+static void wr_table (const LCD_INIT_T *t, unsigned int n) {
+
+  for (; n > 0; n--, t++) {
+    wr_reg(t->reg, t->val);
+    if (t->ms)
+      delay_us(t->ms * 1000);
+  }
+}
 
 
 /************************ Exported functions **********************************/
@@ -305,6 +1087,17 @@ static unsigned short rd_id_man (void) {
 void GLCD_Init (void) {
   unsigned short driverCode;
 
+  shadow_reset();
+#if (GLCD_GLYPH_CACHE > 0)
+  glyph_reset();
+#endif
+
+#ifndef HOST_BUILD
+  /* Start the cycle counter that times the delays                            */
+  DEMCR    |= DEMCR_TRCENA;
+  DWT_CTRL |= 1;
+#endif
+
   /* Enable clock for SSP1, clock = CCLK / 2                                  */
   LPC_SC->PCONP       |= 0x00000400;
   LPC_SC->PCLKSEL0    |= 0x00200000;
@@ -325,198 +1118,48 @@ void GLCD_Init (void) {
   LPC_SSP1->CR0        = 0x01C7;
   LPC_SSP1->CPSR       = 0x02;
   LPC_SSP1->CR1        = 0x02;
+
+#if (GLCD_DMA == 1) && !defined(HOST_BUILD)
+  /* Enable the GPDMA for the glyph bursts                                    */
+  LPC_SC->PCONP       |= 0x20000000;
+  LPC_GPDMA->DMACConfig = 0x01;
+#endif
   
+#if (GLCD_CONTROLLER == GLCD_DETECT)
   driverCode = rd_id_man ();
   if (driverCode == 0) {
     driverCode = rd_reg(0x00);
   }
+#elif (GLCD_CONTROLLER == GLCD_HX8347D)
+  driverCode = 0x47;
+#else
+  driverCode = rd_reg(0x00);            /* Picks the ILI932x init variant     */
+#endif
 
   if (driverCode == 0x47) {             /* LCD with HX8347-D LCD Controller   */
-    Himax = 1;                          /* Set Himax LCD controller flag      */
-    /* Driving ability settings ----------------------------------------------*/
-    wr_reg(0xEA, 0x00);                 /* Power control internal used (1)    */
-    wr_reg(0xEB, 0x20);                 /* Power control internal used (2)    */
-    wr_reg(0xEC, 0x0C);                 /* Source control internal used (1)   */
-    wr_reg(0xED, 0xC7);                 /* Source control internal used (2)   */
-    wr_reg(0xE8, 0x38);                 /* Source output period Normal mode   */
-    wr_reg(0xE9, 0x10);                 /* Source output period Idle mode     */
-    wr_reg(0xF1, 0x01);                 /* RGB 18-bit interface ;0x0110       */
-    wr_reg(0xF2, 0x10);
-
-    /* Adjust the Gamma Curve ------------------------------------------------*/
-    wr_reg(0x40, 0x01);
-    wr_reg(0x41, 0x00);
-    wr_reg(0x42, 0x00);
-    wr_reg(0x43, 0x10);
-    wr_reg(0x44, 0x0E);
-    wr_reg(0x45, 0x24);
-    wr_reg(0x46, 0x04);
-    wr_reg(0x47, 0x50);
-    wr_reg(0x48, 0x02);
-    wr_reg(0x49, 0x13);
-    wr_reg(0x4A, 0x19);
-    wr_reg(0x4B, 0x19);
-    wr_reg(0x4C, 0x16);
-
-    wr_reg(0x50, 0x1B);
-    wr_reg(0x51, 0x31);
-    wr_reg(0x52, 0x2F);
-    wr_reg(0x53, 0x3F);
-    wr_reg(0x54, 0x3F);
-    wr_reg(0x55, 0x3E);
-    wr_reg(0x56, 0x2F);
-    wr_reg(0x57, 0x7B);
-    wr_reg(0x58, 0x09);
-    wr_reg(0x59, 0x06);
-    wr_reg(0x5A, 0x06);
-    wr_reg(0x5B, 0x0C);
-    wr_reg(0x5C, 0x1D);
-    wr_reg(0x5D, 0xCC);
-
-    /* Power voltage setting -------------------------------------------------*/
-    wr_reg(0x1B, 0x1B);
-    wr_reg(0x1A, 0x01);
-    wr_reg(0x24, 0x2F);
-    wr_reg(0x25, 0x57);
-    wr_reg(0x23, 0x88);
-
-    /* Power on setting ------------------------------------------------------*/
-    wr_reg(0x18, 0x36);                 /* Internal oscillator frequency adj  */
-    wr_reg(0x19, 0x01);                 /* Enable internal oscillator         */
-    wr_reg(0x01, 0x00);                 /* Normal mode, no scrool             */
-    wr_reg(0x1F, 0x88);                 /* Power control 6 - DDVDH Off        */
-    delay(20);
-    wr_reg(0x1F, 0x82);                 /* Power control 6 - Step-up: 3 x VCI */
-    delay(5);
-    wr_reg(0x1F, 0x92);                 /* Power control 6 - Step-up: On      */
-    delay(5);
-    wr_reg(0x1F, 0xD2);                 /* Power control 6 - VCOML active     */
-    delay(5);
-
-    /* Color selection -------------------------------------------------------*/
-    wr_reg(0x17, 0x55);                 /* RGB, System interface: 16 Bit/Pixel*/
-    wr_reg(0x00, 0x00);                 /* Scrolling off, no standby          */
-
-    /* Interface config ------------------------------------------------------*/
-    wr_reg(0x2F, 0x11);                 /* LCD Drive: 1-line inversion        */
-    wr_reg(0x31, 0x00);
-    wr_reg(0x32, 0x00);                 /* DPL=0, HSPL=0, VSPL=0, EPL=0       */
-
-    /* Display on setting ----------------------------------------------------*/
-    wr_reg(0x28, 0x38);                 /* PT(0,0) active, VGL/VGL            */
-    delay(20);
-    wr_reg(0x28, 0x3C);                 /* Display active, VGL/VGL            */
-
-   #if (LANDSCAPE == 1)
-    #if (ROTATE180 == 0)
-     wr_reg (0x16, 0xA8);
-    #else
-     wr_reg (0x16, 0x68);
-    #endif
-   #else
-    #if (ROTATE180 == 0)
-     wr_reg (0x16, 0x08);
-    #else
-     wr_reg (0x16, 0xC8);
-    #endif
-   #endif
-
-    /* Display scrolling settings --------------------------------------------*/
-    wr_reg(0x0E, 0x00);                 /* TFA MSB                            */
-    wr_reg(0x0F, 0x00);                 /* TFA LSB                            */
-    wr_reg(0x10, 320 >> 8);             /* VSA MSB                            */
-    wr_reg(0x11, 320 &  0xFF);          /* VSA LSB                            */
-    wr_reg(0x12, 0x00);                 /* BFA MSB                            */
-    wr_reg(0x13, 0x00);                 /* BFA LSB                            */
+    LCD_SELECT(hx);                     /* Use the HX8347-D back end          */
+    WR_TABLE(hx_init);
   }
   else {
-    Himax = 0;                          /* This is not Himax LCD controller   */
-    /* Start Initial Sequence ------------------------------------------------*/
-   #if (ROTATE180 == 1)
-    wr_reg(0x01, 0x0000);               /* Clear SS bit                       */
-   #else
-    wr_reg(0x01, 0x0100);               /* Set SS bit                         */
-   #endif
-    wr_reg(0x02, 0x0700);               /* Set 1 line inversion               */
-    wr_reg(0x04, 0x0000);               /* Resize register                    */
-    wr_reg(0x08, 0x0207);               /* 2 lines front, 7 back porch        */
-    wr_reg(0x09, 0x0000);               /* Set non-disp area refresh cyc ISC  */
-    wr_reg(0x0A, 0x0000);               /* FMARK function                     */
-    wr_reg(0x0C, 0x0000);               /* RGB interface setting              */
-    wr_reg(0x0D, 0x0000);               /* Frame marker Position              */
-    wr_reg(0x0F, 0x0000);               /* RGB interface polarity             */
-
-    /* Power On sequence -----------------------------------------------------*/
-    wr_reg(0x10, 0x0000);               /* Reset Power Control 1              */
-    wr_reg(0x11, 0x0000);               /* Reset Power Control 2              */
-    wr_reg(0x12, 0x0000);               /* Reset Power Control 3              */
-    wr_reg(0x13, 0x0000);               /* Reset Power Control 4              */
-    delay(20);                          /* Discharge cap power voltage (200ms)*/
-    wr_reg(0x10, 0x12B0);               /* SAP, BT[3:0], AP, DSTB, SLP, STB   */
-    wr_reg(0x11, 0x0007);               /* DC1[2:0], DC0[2:0], VC[2:0]        */
-    delay(5);                           /* Delay 50 ms                        */
-    wr_reg(0x12, 0x01BD);               /* VREG1OUT voltage                   */
-    delay(5);                           /* Delay 50 ms                        */
-    wr_reg(0x13, 0x1400);               /* VDV[4:0] for VCOM amplitude        */
-    wr_reg(0x29, 0x000E);               /* VCM[4:0] for VCOMH                 */
-    delay(5);                           /* Delay 50 ms                        */
-    wr_reg(0x20, 0x0000);               /* GRAM horizontal Address            */
-    wr_reg(0x21, 0x0000);               /* GRAM Vertical Address              */
+    LCD_SELECT(ili);                    /* Use the ILI932x back end           */
+    WR_TABLE(ili_init);
 
     /* Adjust the Gamma Curve ------------------------------------------------*/
     switch (driverCode) {
       case 0x5408:                      /* LCD with SPFD5408 LCD Controller   */
-        wr_reg(0x30, 0x0B0D);
-        wr_reg(0x31, 0x1923);
-        wr_reg(0x32, 0x1C26);
-        wr_reg(0x33, 0x261C);
-        wr_reg(0x34, 0x2419);
-        wr_reg(0x35, 0x0D0B);
-        wr_reg(0x36, 0x1006);
-        wr_reg(0x37, 0x0610);
-        wr_reg(0x38, 0x0706);
-        wr_reg(0x39, 0x0304);
-        wr_reg(0x3A, 0x0E05);
-        wr_reg(0x3B, 0x0E01);
-        wr_reg(0x3C, 0x010E);
-        wr_reg(0x3D, 0x050E);
-        wr_reg(0x3E, 0x0403);
-        wr_reg(0x3F, 0x0607);
+        WR_TABLE(ili_gamma_5408);
         break;
 
       case 0x9325:                      /* LCD with RM68050 LCD Controller    */
-        wr_reg(0x0030,0x0000);
-        wr_reg(0x0031,0x0607);
-        wr_reg(0x0032,0x0305);
-        wr_reg(0x0035,0x0000);
-        wr_reg(0x0036,0x1604);
-        wr_reg(0x0037,0x0204);
-        wr_reg(0x0038,0x0001);
-        wr_reg(0x0039,0x0707);
-        wr_reg(0x003C,0x0000);
-        wr_reg(0x003D,0x000F);
+        WR_TABLE(ili_gamma_9325);
         break;
 
       case 0x9320:                      /* LCD with ILI9320 LCD Controller    */
       default:                          /* LCD with other LCD Controller      */
-        wr_reg(0x30, 0x0006);
-        wr_reg(0x31, 0x0101);
-        wr_reg(0x32, 0x0003);
-        wr_reg(0x35, 0x0106);
-        wr_reg(0x36, 0x0B02);
-        wr_reg(0x37, 0x0302);
-        wr_reg(0x38, 0x0707);
-        wr_reg(0x39, 0x0007);
-        wr_reg(0x3C, 0x0600);
-        wr_reg(0x3D, 0x020B);
+        WR_TABLE(ili_gamma_9320);
         break;
     }
-
-    /* Set GRAM area ---------------------------------------------------------*/
-    wr_reg(0x50, 0x0000);               /* Horizontal GRAM Start Address      */
-    wr_reg(0x51, (HEIGHT-1));           /* Horizontal GRAM End   Address      */
-    wr_reg(0x52, 0x0000);               /* Vertical   GRAM Start Address      */
-    wr_reg(0x53, (WIDTH-1));            /* Vertical   GRAM End   Address      */
+    WR_TABLE(ili_area);
 
     /* Set Gate Scan Line ----------------------------------------------------*/
     switch (driverCode) {
@@ -538,33 +1181,16 @@ void GLCD_Init (void) {
        #endif
         break;
     }
-    wr_reg(0x61, 0x0001);               /* NDL,VLE, REV                       */
-    wr_reg(0x6A, 0x0000);               /* Set scrolling line                 */
-
-    /* Partial Display Control -----------------------------------------------*/
-    wr_reg(0x80, 0x0000);
-    wr_reg(0x81, 0x0000);
-    wr_reg(0x82, 0x0000);
-    wr_reg(0x83, 0x0000);
-    wr_reg(0x84, 0x0000);
-    wr_reg(0x85, 0x0000);
-
-    /* Panel Control ---------------------------------------------------------*/
-    wr_reg(0x90, 0x0010);
-    wr_reg(0x92, 0x0000);
-    wr_reg(0x93, 0x0003);
-    wr_reg(0x95, 0x0110);
-    wr_reg(0x97, 0x0000);
-    wr_reg(0x98, 0x0000);
+    WR_TABLE(ili_panel);
 
     /* Set GRAM write direction
        I/D=11 (Horizontal : increment, Vertical : increment)                  */
   #if (LANDSCAPE == 1)
     /* AM=1   (address is updated in vertical writing direction)              */
-    wr_reg(0x03, 0x1038);
+    wr_reg_shadow(SH_ENTRY, 0x03, 0x1038);
   #else
     /* AM=0   (address is updated in horizontal writing direction)            */
-    wr_reg(0x03, 0x1030);
+    wr_reg_shadow(SH_ENTRY, 0x03, 0x1030);
   #endif
 
     wr_reg(0x07, 0x0137);               /* 262K color and display ON          */
@@ -583,39 +1209,8 @@ void GLCD_Init (void) {
 *******************************************************************************/
 
 void GLCD_SetWindow (unsigned int x, unsigned int y, unsigned int w, unsigned int h) {
-  unsigned int xe, ye;
-
-  if (Himax) {
-    xe = x+w-1;
-    ye = y+h-1;
 
-    wr_reg(0x02, x  >>    8);           /* Column address start MSB           */
-    wr_reg(0x03, x  &  0xFF);           /* Column address start LSB           */
-    wr_reg(0x04, xe >>    8);           /* Column address end MSB             */
-    wr_reg(0x05, xe &  0xFF);           /* Column address end LSB             */
-  
-    wr_reg(0x06, y  >>    8);           /* Row address start MSB              */
-    wr_reg(0x07, y  &  0xFF);           /* Row address start LSB              */
-    wr_reg(0x08, ye >>    8);           /* Row address end MSB                */
-    wr_reg(0x09, ye &  0xFF);           /* Row address end LSB                */
-  }
-  else {
-   #if (LANDSCAPE == 1)
-    wr_reg(0x50, y);                    /* Vertical   GRAM Start Address      */
-    wr_reg(0x51, y+h-1);                /* Vertical   GRAM End   Address (-1) */
-    wr_reg(0x52, x);                    /* Horizontal GRAM Start Address      */
-    wr_reg(0x53, x+w-1);                /* Horizontal GRAM End   Address (-1) */
-    wr_reg(0x20, y);
-    wr_reg(0x21, x);
-   #else
-    wr_reg(0x50, x);                    /* Horizontal GRAM Start Address      */
-    wr_reg(0x51, x+w-1);                /* Horizontal GRAM End   Address (-1) */
-    wr_reg(0x52, y);                    /* Vertical   GRAM Start Address      */
-    wr_reg(0x53, y+h-1);                /* Vertical   GRAM End   Address (-1) */
-    wr_reg(0x20, x);
-    wr_reg(0x21, y);
-   #endif
-  }
+  LCD_OP(set_window)(x, y, w, h);
 }
 
 
@@ -639,29 +1234,7 @@ void GLCD_WindowMax (void) {
 
 void GLCD_PutPixel (unsigned int x, unsigned int y) {
 
-  if (Himax) {
-    wr_reg(0x02, x >>    8);            /* Column address start MSB           */
-    wr_reg(0x03, x &  0xFF);            /* Column address start LSB           */
-    wr_reg(0x04, x >>    8);            /* Column address end MSB             */
-    wr_reg(0x05, x &  0xFF);            /* Column address end LSB             */
-  
-    wr_reg(0x06, y >>    8);            /* Row address start MSB              */
-    wr_reg(0x07, y &  0xFF);            /* Row address start LSB              */
-    wr_reg(0x08, y >>    8);            /* Row address end MSB                */
-    wr_reg(0x09, y &  0xFF);            /* Row address end LSB                */
-  }
-  else {
-   #if (LANDSCAPE == 1)
-    wr_reg(0x20, y);
-    wr_reg(0x21, x);
-   #else
-    wr_reg(0x20, x);
-    wr_reg(0x21, y);
-   #endif
-  }
-
-  wr_cmd(0x22);
-  wr_dat(Color[TXT_COLOR]);
+  LCD_OP(put_pixel)(x, y, Color[TXT_COLOR]);
 }
 
 
@@ -708,6 +1281,64 @@ void GLCD_Clear (unsigned short color) {
 }
 
 
+/*******************************************************************************
+* Start a display clear that is sent by GLCD_ClearStep, a band of rows at a    *
+* time from the top, instead of blocking for the whole screen. A clear that    *
+* is still running is given up without calling its done function              *
+*   Parameter:      color:    display clearing color                           *
+*                   done:     called by the step that clears the last row,     *
+*                             0 for none                                       *
+*   Return:                                                                    *
+*******************************************************************************/
+
+void GLCD_ClearStart (unsigned short color, void (*done)(void)) {
+
+  ClearColor = color;
+  ClearDone  = done;
+  ClearLeft  = HEIGHT;
+}
+
+
+/*******************************************************************************
+* Clear the next band of rows of the clear begun by GLCD_ClearStart, as many   *
+* whole rows as fit into the byte budget but at least one. The window is the   *
+* whole screen again after every step                                          *
+*   Parameter:      budget:   SPI bytes of pixel data this step may send       *
+*   Return:                   1 while rows are left to clear, 0 when none      *
+*******************************************************************************/
+
+int GLCD_ClearStep (unsigned int budget) {
+  unsigned int i, rows;
+  void (*done)(void);
+
+  if (ClearLeft == 0)
+    return 0;
+
+  rows = budget / (WIDTH*BYPP);
+  if (rows == 0)
+    rows = 1;
+  if (rows > ClearLeft)
+    rows = ClearLeft;
+
+  GLCD_SetWindow(0, HEIGHT - ClearLeft, WIDTH, rows);
+  wr_cmd(0x22);
+  wr_dat_start();
+  for (i = 0; i < rows*WIDTH; i++)
+    wr_dat_only(ClearColor);
+  wr_dat_stop();
+  GLCD_WindowMax();
+
+  ClearLeft -= rows;
+  if (ClearLeft > 0)
+    return 1;
+  done      = ClearDone;                /* The done function may start again  */
+  ClearDone = 0;
+  if (done)
+    done();
+  return 0;
+}
+
+
 /*******************************************************************************
 * Draw character on given position                                             *
 *   Parameter:      x:        horizontal position                              *
@@ -720,12 +1351,33 @@ void GLCD_Clear (unsigned short color) {
 
 void GLCD_DrawChar (unsigned int x, unsigned int y, unsigned int cw, unsigned int ch, unsigned char *c) {
   unsigned int i, j, k, pixs;
+  unsigned short color[2];
+#if (GLCD_GLYPH_CACHE > 0)
+  GLYPH_T *g;
+#endif
 
   GLCD_SetWindow(x, y, cw, ch);
 
   wr_cmd(0x22);
+#if (GLCD_GLYPH_CACHE > 0)
+  if (cw <= 16 && cw*ch <= GLYPH_PIXELS) {
+    g = glyph_get(c, cw, ch);
+    wr_dat_start();
+   #if (GLCD_DMA == 1)
+    dma_send(g->pixels, cw*ch);         /* The burst ends in dma_finish       */
+   #else
+    for (i = 0; i < cw*ch; i++)
+      wr_dat_only(g->pixels[i]);
+    wr_dat_stop();
+   #endif
+    return;
+  }
+#endif
   wr_dat_start();
 
+  color[BG_COLOR]  = Color[BG_COLOR];
+  color[TXT_COLOR] = Color[TXT_COLOR];
+
   k  = (cw + 7)/8;
 
   if (k == 1) {
@@ -734,7 +1386,7 @@ void GLCD_DrawChar (unsigned int x, unsigned int y, unsigned int cw, unsigned in
       c += 1;
       
       for (i = 0; i < cw; i++) {
-        wr_dat_only (Color[(pixs >> i) & 1]);
+        wr_dat_only (color[(pixs >> i) & 1]);
       }
     }
   }
@@ -744,7 +1396,7 @@ void GLCD_DrawChar (unsigned int x, unsigned int y, unsigned int cw, unsigned in
       c += 2;
       
       for (i = 0; i < cw; i++) {
-        wr_dat_only (Color[(pixs >> i) & 1]);
+        wr_dat_only (color[(pixs >> i) & 1]);
       }
     }
   }
@@ -830,7 +1482,7 @@ void GLCD_ClearLn (unsigned int ln, unsigned char fi) {
 *******************************************************************************/
 
 void GLCD_Bargraph (unsigned int x, unsigned int y, unsigned int w, unsigned int h, unsigned int val) {
-  int i,j;
+  unsigned int i,j;
 
   val = (val * w) >> 10;                /* Scale value                        */
   GLCD_SetWindow(x, y, w, h);
@@ -870,7 +1522,7 @@ void GLCD_Bitmap (unsigned int x, unsigned int y, unsigned int w, unsigned int h
   wr_cmd(0x22);
   wr_dat_start();
   for (i = (h-1)*w; i > -1; i -= w) {
-    for (j = 0; j < w; j++) {
+    for (j = 0; j < (int)w; j++) {
       wr_dat_only (bitmap_ptr[i+j]);
     }
   }
@@ -878,6 +1530,163 @@ void GLCD_Bitmap (unsigned int x, unsigned int y, unsigned int w, unsigned int h
 }
 
 
+/*******************************************************************************
+* Display a palette and run length coded bitmap at position x horizontally and *
+* y vertically, as made by host/rlegen.c. The runs are decoded straight into   *
+* the GRAM data burst, top row first, a run may go on over the row end.        *
+*   Stream:         width and height (16 bit each), colors - 1 (8 bit), the    *
+*                   palette (16 bit RGB565 each), then the runs:               *
+*                   0x00..0x7F  code + 1 palette indexes follow (literal run)  *
+*                   0x80..0xFE  (code & 0x7F) + 1 pixels of the next index     *
+*                   0xFF        16 bit count, then the index (long fill)       *
+*                   16 bit values are stored low byte first                    *
+*                   a run past the last pixel is cut off at the window end     *
+*   Parameter:      x:        horizontal position                              *
+*                   y:        vertical position                                *
+*                   rle:      address at which the coded bitmap resides        *
+*   Return:                                                                    *
+*******************************************************************************/
+
+void GLCD_BitmapRLE (unsigned int x, unsigned int y, const unsigned char *rle) {
+  const unsigned char *pal;
+  unsigned int w, h, left, n;
+  unsigned short color;
+  unsigned char code;
+
+  w    = rle[0] | (rle[1] << 8);
+  h    = rle[2] | (rle[3] << 8);
+  pal  = rle + 5;
+  rle  = pal + 2*(rle[4] + 1);
+  left = w*h;
+
+  GLCD_SetWindow(x, y, w, h);
+
+  wr_cmd(0x22);
+  wr_dat_start();
+  while (left > 0) {
+    code = *rle++;
+    if (code & 0x80) {
+      if (code == 0xFF) {
+        n    = rle[0] | (rle[1] << 8);
+        rle += 2;
+      } else {
+        n = (code & 0x7F) + 1;
+      }
+      color = pal[2*(*rle)] | (pal[2*(*rle) + 1] << 8);
+      rle++;
+      if (n > left)
+        n = left;
+      left -= n;
+      while (n--)
+        wr_dat_only(color);
+    } else {
+      n = code + 1;
+      if (n > left)
+        n = left;
+      left -= n;
+      while (n--) {
+        wr_dat_only(pal[2*(*rle)] | (pal[2*(*rle) + 1] << 8));
+        rle++;
+      }
+    }
+  }
+  wr_dat_stop();
+}
+
+
+/*******************************************************************************
+* Color of pixel i of an atlas, through the palette for an indexed atlas       *
+*   Parameter:      atlas:    atlas the pixel is taken from                    *
+*                   i:        offset of the pixel from the atlas start         *
+*   Return:                   RGB565 color                                     *
+*******************************************************************************/
+
+static __inline unsigned short atlas_pixel (const GLCD_ATLAS_T *atlas, unsigned int i) {
+
+  if (atlas->palette)
+    return atlas->palette[((const unsigned char *)atlas->pixels)[i]];
+  return ((const unsigned short *)atlas->pixels)[i];
+}
+
+
+/*******************************************************************************
+* Copy a w x h rectangle from (sx, sy) of an atlas to (x, y) of the display,   *
+* top row first. Pixels of the key color are left as they are on the display:  *
+* every row is split into spans of other colors, each one a cursor move and a  *
+* GRAM burst inside the window of the whole rectangle                          *
+*   Parameter:      x:        horizontal position                              *
+*                   y:        vertical position                                *
+*                   atlas:    RGB565 or indexed source image                   *
+*                   sx:       horizontal position in the atlas                 *
+*                   sy:       vertical position in the atlas                   *
+*                   w:        width of the rectangle                           *
+*                   h:        height of the rectangle                          *
+*                   key:      transparent color, GLCD_OPAQUE for none          *
+*   Return:                                                                    *
+*******************************************************************************/
+
+void GLCD_BlitSub (unsigned int x, unsigned int y, const GLCD_ATLAS_T *atlas,
+                   unsigned int sx, unsigned int sy, unsigned int w, unsigned int h, unsigned int key) {
+  unsigned int i, j, row;
+
+  GLCD_SetWindow(x, y, w, h);
+
+  if (key == GLCD_OPAQUE) {             /* The whole rectangle in one burst   */
+    wr_cmd(0x22);
+    wr_dat_start();
+    for (j = 0; j < h; j++) {
+      row = (sy + j) * atlas->stride + sx;
+      for (i = 0; i < w; i++)
+        wr_dat_only(atlas_pixel(atlas, row + i));
+    }
+    wr_dat_stop();
+    return;
+  }
+
+  for (j = 0; j < h; j++) {
+    row = (sy + j) * atlas->stride + sx;
+    i   = 0;
+    for (;;) {
+      while (i < w && atlas_pixel(atlas, row + i) == key)
+        i++;                            /* Skip the transparent pixels        */
+      if (i == w)
+        break;
+      LCD_OP(set_cursor)(x + i, y + j);
+      wr_cmd(0x22);
+      wr_dat_start();
+      do {
+        wr_dat_only(atlas_pixel(atlas, row + i));
+      } while (++i < w && atlas_pixel(atlas, row + i) != key);
+      wr_dat_stop();
+    }
+  }
+}
+
+
+/*******************************************************************************
+* Write a block of pixels to the display, top row first                        *
+*   Parameter:      x:        horizontal position                              *
+*                   y:        vertical position                                *
+*                   w:        width of the block in pixels                     *
+*                   h:        height of the block in pixels                    *
+*                   data:     w*h pixel colors, row after row                  *
+*   Return:                                                                    *
+*******************************************************************************/
+
+void GLCD_WriteWindow (unsigned int x, unsigned int y, unsigned int w, unsigned int h, const unsigned short *data) {
+  unsigned int i;
+
+  GLCD_SetWindow(x, y, w, h);
+
+  wr_cmd(0x22);
+  wr_dat_start();
+  for (i = 0; i < w*h; i++) {
+    wr_dat_only(data[i]);
+  }
+  wr_dat_stop();
+}
+
+
 
 /*******************************************************************************
 * Scroll content of the whole display for dy pixels vertically                 *
@@ -893,19 +1702,60 @@ void GLCD_ScrollVertical (unsigned int dy) {
   while (y >= HEIGHT)
     y -= HEIGHT;
 
-  if (Himax) {
-    wr_reg(0x01, 0x08);
-    wr_reg(0x14, y>>8);                 /* VSP MSB                            */
-    wr_reg(0x15, y&0xFF);               /* VSP LSB                            */
-  }
-  else {
-    wr_reg(0x6A, y);
-    wr_reg(0x61, 3);
-  }
+  LCD_OP(scroll)(y);
+#else
+  (void)dy;
 #endif
 }
 
 
+/*******************************************************************************
+* Set the GRAM address without changing the draw window, the pixels written    *
+* next go from (x, y) to the right as long as the window is the whole screen   *
+*   Parameter:      x:        horizontal position                              *
+*                   y:        vertical position                                *
+*   Return:                                                                    *
+*******************************************************************************/
+void GLCD_SetCursor (unsigned int x, unsigned int y) {
+
+  LCD_OP(set_cursor)(x, y);
+}
+
+
+/*******************************************************************************
+* Select the direction of the pixel data that follows a GLCD_SetCursor: down   *
+* the column from the cursor when on, along the row when off. The draw window  *
+* has to be the whole screen, switch back off when done since the rest of the  *
+* driver writes along the rows                                                 *
+*   Parameter:      on:       1 for columns, 0 for rows                        *
+*   Return:                                                                    *
+*******************************************************************************/
+void GLCD_SetVertical (unsigned int on) {
+
+  Vertical = (on != 0);
+  LCD_OP(set_vertical)(Vertical);
+}
+
+
+/*******************************************************************************
+* Start, continue and stop a burst of pixel data, GLCD_WrCmd(0x22) has to be   *
+* sent before the start                                                        *
+*   Parameter:      dat:      pixel color                                      *
+*   Return:                                                                    *
+*******************************************************************************/
+void GLCD_WrDatStart (void) {
+  wr_dat_start();
+}
+
+void GLCD_WrDatOnly (unsigned short dat) {
+  wr_dat_only(dat);
+}
+
+void GLCD_WrDatStop (void) {
+  wr_dat_stop();
+}
+
+
 /*******************************************************************************
 * Write a command to the LCD controller                                        *
 *   Parameter:      cmd:      command to write to the LCD                      *
@@ -923,6 +1773,7 @@ void GLCD_WrCmd (unsigned char cmd) {
 *   Return:                                                                    *
 *******************************************************************************/
 void GLCD_WrReg (unsigned char reg, unsigned short val) {
+  shadow_reset ();                      /* reg may be one of the shadowed     */
   wr_reg (reg, val);
 }
 /******************************************************************************/
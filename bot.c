@@ -0,0 +1,72 @@
+#include <stdint.h>
+#include "game.h"
+#include "bot.h"
+
+// the pot range of getPlayerAngle, +/-157.5 degrees in binary angle units
+#define BOT_MAX_ANGLE (ANGLE_STEPS * 7 / 16)
+
+// speed of a bullet in pixels per tick, see moveBullet
+#define BULLET_SPEED 7
+
+int botFirePeriod = BOT_FIRE_PERIOD;
+
+static uint32_t botTick = 0;
+static angle_t botAim = 0;
+static int botTarget = 0;
+
+void botReset(void){
+	botTick = 0;
+	botAim = 0;
+	botTarget = 0;
+}
+
+angle_t botAngle(void){
+	// function to aim at the live enemy that is closest to the player
+	int i;
+	int best = -1;
+	int32_t bestDist = 0;
+	int32_t x;
+	int32_t y;
+	int32_t dist;
+
+	for (i = 0; i < enemyCount; i++) {
+		if (enemies[i].point.x == DEADPOINTLOC || enemies[i].point.y == DEADPOINTLOC) {
+			continue;
+		}
+		x = enemies[i].point.x - WIDTH/2;
+		y = enemies[i].point.y - 10;
+		dist = x*x + y*y;
+		if (best == -1 || dist < bestDist) {
+			best = i;
+			bestDist = dist;
+		}
+	}
+	botTarget = best != -1;
+	if (!botTarget) {
+		//hold the last angle if there is nothing to shoot at
+		return botAim;
+	}
+	//lead the target to where it meets the bullet, the enemy moves difficulty pixels
+	//per tick straight towards the player and the bullet BULLET_SPEED pixels away
+	//from it, so they close in at the sum of both and meet after the enemy has come
+	//difficulty/(BULLET_SPEED + difficulty) of its distance, always less than all of it
+	x = enemies[best].point.x - WIDTH/2;
+	y = enemies[best].point.y - 10;
+	x -= x * difficulty / (BULLET_SPEED + difficulty);
+	y -= y * difficulty / (BULLET_SPEED + difficulty);
+	//fireBullet moves the bullet by (sin(-angle), cos(-angle))
+	botAim = atan2Angle(-x, y);
+	if (botAim > BOT_MAX_ANGLE) {
+		botAim = BOT_MAX_ANGLE;
+	} else if (botAim < -BOT_MAX_ANGLE) {
+		botAim = -BOT_MAX_ANGLE;
+	}
+	return botAim;
+}
+
+int botButton(void){
+	// function to press the button for one tick every botFirePeriod ticks while there is a target
+	int pressed = botTarget && (botTick % botFirePeriod) == 0;
+	botTick++;
+	return pressed;
+}
@@ -0,0 +1,28 @@
+#ifndef _BOT_H
+#define _BOT_H
+
+#include "trig.h"
+
+// ticks between two bullets fired by the bot, the button has to be released in
+// between two presses so the fastest rate is one bullet every 2 ticks
+#ifndef BOT_FIRE_PERIOD
+    #define BOT_FIRE_PERIOD 4
+#endif
+
+// seed used for the game when the bot replaces the start button
+#ifndef BOT_SEED
+    #define BOT_SEED 2000000
+#endif
+
+// fire period used by botButton, starts out as BOT_FIRE_PERIOD
+extern int botFirePeriod;
+
+void botReset(void);
+
+// player angle aimed at the nearest live enemy, replaces getPlayerAngle
+angle_t botAngle(void);
+
+// button state for the current tick, replaces the P2.10 read
+int botButton(void);
+
+#endif /* _BOT_H */
@@ -0,0 +1,325 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include "queue.h"
+#include "game.h"
+#include "render.h"
+
+// delcare global variables for enemies
+node_t *enemyIndexHead = NULL;
+enemy_t enemies[MAX_ENEMIES];
+int enemyCount = 0;
+int liveEnemies = 0;
+
+//declare global variables for bullets
+node_t *bulletIndexHead = NULL;
+bullet_t bullets[MAX_BULLETS];
+int bulletCount = 0;
+int liveBullets = 0;
+
+//declare global variables for players
+angle_t prev_player_angle = 0;
+angle_t player_angle = 0;
+int playerDirty = 1;
+
+int kills = 0;
+int lives = START_LIVES;
+int difficulty = 1;
+
+//declare global variables for the enemy spawn counter and the random number generator
+uint32_t spawnCount = 0;
+uint32_t rngState = 1;
+
+//filtered pot value with 4 fraction bits, -1 until the first sample, and the current angle step
+static int32_t potFiltered = -1;
+static int potCurrent = 0;
+
+State gameState = GameScreen;
+
+void resetGame(void){
+	// function to put the game back into the state it has at power on
+	int i;
+	//empty the free index queues
+	while (dequeue(&enemyIndexHead) != -1);
+	while (dequeue(&bulletIndexHead) != -1);
+	for (i = 0; i < MAX_ENEMIES; i++) {
+		enemies[i].dx = 0;
+		enemies[i].dy = 0;
+		enemies[i].point.x = enemies[i].point.y = 0;
+		enemies[i].prevPoint.x = enemies[i].prevPoint.y = 0;
+		enemies[i].dirty = 0;
+	}
+	for (i = 0; i < MAX_BULLETS; i++) {
+		bullets[i].dx = 0;
+		bullets[i].dy = 0;
+		bullets[i].point.x = bullets[i].point.y = 0;
+		bullets[i].prevPoint.x = bullets[i].prevPoint.y = 0;
+		bullets[i].dirty = 0;
+	}
+	enemyCount = 0;
+	liveEnemies = 0;
+	bulletCount = 0;
+	liveBullets = 0;
+	prev_player_angle = 0;
+	player_angle = 0;
+	playerDirty = 1;
+	kills = 0;
+	lives = START_LIVES;
+	difficulty = 1;
+	spawnCount = 0;
+	gameState = GameScreen;
+	potReset();
+}
+
+void gameSeed(uint32_t seed){
+	rngState = seed;
+}
+
+int gameRand(void){
+	// linear congruential generator with the same constants and range as the C library rand()
+	rngState = rngState * 1103515245 + 12345;
+	return (rngState >> 16) & 0x7FFF;
+}
+
+void moveEnemy(int i) {
+	// function for moving a single enemy, it accepts the index of the enemy in the enemy array
+	int direction;
+	if (enemies[i].point.x == DEADPOINTLOC || enemies[i].point.y == DEADPOINTLOC) {
+		//if the enemy is at the dead point the enemy does not get moved
+		return;
+	}
+	//update the movement distance ratio per tick from the direction of the player to have the enemy converge to the player
+	direction = atan2Angle(enemies[i].point.y - 10, enemies[i].point.x - 160);
+	enemies[i].dy = sinQ15(direction);
+	enemies[i].dx = cosQ15(direction);
+	//set previous point to current point
+	enemies[i].prevPoint.x = enemies[i].point.x;
+	enemies[i].prevPoint.y = enemies[i].point.y;
+	//update current point based on the difficulty and movement ratio, rounded to the nearest pixel
+	enemies[i].point.x = enemies[i].point.x + ((-difficulty * enemies[i].dx + (1 << 14)) >> 15);
+	enemies[i].point.y = enemies[i].point.y + ((-difficulty * enemies[i].dy + (1 << 14)) >> 15);
+	//only redraw the enemy if the move changed a pixel position
+	if (enemies[i].point.x != enemies[i].prevPoint.x || enemies[i].point.y != enemies[i].prevPoint.y) {
+		enemies[i].dirty = 1;
+	}
+}
+
+void moveBullet(int i) {
+	// function for moving a single bullet, it accepts the index of the bullet in the bullet array
+	if (bullets[i].point.x == DEADPOINTLOC && bullets[i].point.y == DEADPOINTLOC) {
+		//if the bullet is at the dead point the bullet does not get moved
+		return;
+	}
+	//set previous point to current point
+	bullets[i].prevPoint.x = bullets[i].point.x;
+	bullets[i].prevPoint.y = bullets[i].point.y;
+	//update the current bullet location for its moved point
+	bullets[i].point.x = bullets[i].point.x + ((7 * bullets[i].dx + (1 << 14)) >> 15);
+	bullets[i].point.y = bullets[i].point.y + ((7 * bullets[i].dy + (1 << 14)) >> 15);
+	if (bullets[i].point.x != bullets[i].prevPoint.x || bullets[i].point.y != bullets[i].prevPoint.y) {
+		bullets[i].dirty = 1;
+	}
+	
+	//if the bullet is off the screen, remove it from the array
+	if (bullets[i].point.x > WIDTH || bullets[i].point.x < 0 || bullets[i].point.y > HEIGHT || bullets[i].point.y < 0) {
+		//decrements live bullets
+		liveBullets--;
+		//enque the dead bullets index into the bullet queue so the next bullet that is made will use this index to conserve memory
+		enqueue(&bulletIndexHead, i);
+		//erase the dead bullet so it doesn't stay on the screen
+		drawBullet(bullets[i].prevPoint, 0);
+		//set the bullets point to the Dead point
+		bullets[i].point.x = DEADPOINTLOC;
+		bullets[i].point.y = DEADPOINTLOC;
+	}
+}
+
+void fireBullet() {
+	// function to fire a bullet
+	int index;
+	angle_t angle = player_angle;
+	 // only allow a max of 15 bullets on the screen at a time
+	if (liveBullets > 15) {
+		return;
+	}
+	// if there is an available index in the queue, it will be used
+	if ((index=dequeue(&bulletIndexHead)) > 0) {
+	} 
+	// otherwise a new index is created
+	else {
+		bulletCount++;
+		index = bulletCount;
+	}
+	liveBullets++;
+	
+	//initalize the movement parameters, and the start point, then move the bullet
+	bullets[index].point.x = WIDTH/2;
+	bullets[index].point.y = 10;
+	bullets[index].dy = cosQ15(-angle);
+	bullets[index].dx = sinQ15(-angle);
+	bullets[index].dirty = 1;
+	moveBullet(index);
+}
+
+int checkPlayerCollision(int index) {
+	//function to check if a single enemy collided with the player, given the enemies index
+	if (enemies[index].point.x > WIDTH/2 - 20 && enemies[index].point.x < WIDTH/2 + 20) {
+		if (enemies[index].point.y > 10 - 10 && enemies[index].point.y < 10 + 10) {
+			liveEnemies--;
+			lives--;
+			//add the dead enemies index to the waiting queue to be reused
+			enqueue(&enemyIndexHead, index);
+			enemies[index].point.x = DEADPOINTLOC;
+			enemies[index].point.y = DEADPOINTLOC;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+int checkBulletCollision(int index) {
+	//function to check if a bullet (given an index) collides with any enemy
+	int i;
+	int hitbox = 7;
+	for (i = 0; i < enemyCount; i++) {
+		if (bullets[index].point.x > enemies[i].point.x - hitbox && bullets[index].point.x < enemies[i].point.x + hitbox) {
+			if (bullets[index].point.y > enemies[i].point.y - hitbox && bullets[index].point.y < enemies[i].point.y + hitbox) {
+				liveEnemies--;
+				liveBullets--;
+				kills++;
+				
+				//increase the difficulty every 5 kills
+				if (kills % 5 == 0){
+					difficulty ++;
+				}
+				
+				//add the dead enemies index to the waiting queue to be reused
+				enqueue(&enemyIndexHead, i);
+				enemies[i].point.x = DEADPOINTLOC;
+				enemies[i].point.y = DEADPOINTLOC;
+				//add the dead bullets index to the waiting queue to be reused
+				enqueue(&bulletIndexHead, index);
+				bullets[index].point.x = DEADPOINTLOC;
+				bullets[index].point.y = DEADPOINTLOC;
+				
+				return i;
+			}
+		}
+	}
+	return -1;
+}
+
+angle_t potAngle(int potValue){
+	// function to map the 12 bit potentiometer value to the player angle, +/-157.5 degrees
+	// the angle is (157.5 - potValue/13) degrees, or (4095 - 2*potValue)*64/585 binary units
+	int32_t num = (4095 - 2 * potValue) * 64;
+	return (angle_t)((num >= 0 ? num + 585/2 : num - 585/2) / 585);
+}
+
+void potReset(void){
+	// the next pot sample starts the filter over
+	potFiltered = -1;
+	potCurrent = 0;
+}
+
+int potStep(int potValue){
+	// function to turn a raw 12 bit pot sample into an angle step, the sample is
+	// low pass filtered and the step only changes once the filtered value is
+	// POT_HYSTERESIS counts past the edge of the current step
+	int32_t width = 4096 / POT_STEPS;
+	int32_t value;
+	if (potFiltered < 0) {
+		potFiltered = potValue << 4;
+		potCurrent = potValue / width;
+	} else {
+		potFiltered += ((potValue << 4) - potFiltered) >> POT_FILTER_SHIFT;
+	}
+	value = potFiltered >> 4;
+	if (value < potCurrent * width - POT_HYSTERESIS || value >= (potCurrent + 1) * width + POT_HYSTERESIS) {
+		potCurrent = value / width;
+	}
+	return potCurrent;
+}
+
+angle_t stepAngle(int step){
+	// function to return the player angle at the centre of an angle step
+	return potAngle(step * (4096 / POT_STEPS) + (4096 / POT_STEPS) / 2);
+}
+
+void setPlayerAngle(angle_t angle){
+	// function for the player task to set a new player angle, the player is only redrawn if it changed
+	if (angle != player_angle) {
+		playerDirty = 1;
+	}
+	player_angle = angle;
+}
+
+void generateEnemy(void) { 
+	//function to generate an enemy at a random spot on the outside of the screen
+	int32_t x;
+	int32_t y;
+	int index;
+	
+	//generate the enemy on a random side of a screen
+	uint32_t side = gameRand() % 3 + 1;
+	
+	//if it is on either side of the screen,
+	//the y value will generate randomly 
+	//the x value will be either 0 or the width of the screen
+	if(side == 1 || side == 3){
+		y = (gameRand() % (HEIGHT-50)) + 50;
+		x = side == 1 ? 0 : WIDTH;
+	}
+	//if it is on tghe opposite side of the screen,
+	//the y value will be the height of the screen 
+	//the x value will generate randomly along the width of the screen
+	else {
+		y = HEIGHT;
+		x = gameRand() % WIDTH;
+	}
+	//if there is an index in the enemy index queue, it will be used
+	if ((index=dequeue(&enemyIndexHead)) > 0) {
+	}
+	//otherwise a new index will be created
+	else if (enemyCount < MAX_ENEMIES - 1) {
+		enemyCount++;
+		index = enemyCount;
+	}
+	//if the enemy array is full no enemy is spawned
+	else {
+		return;
+	}
+	//increment living enemies, and set its initial location
+	liveEnemies++;
+	enemies[index].point.x = x;
+	enemies[index].point.y = y;
+	enemies[index].dirty = 1;
+}
+
+void updateEnemies(void){
+	// function for one tick of the enemy task
+	int i;
+	int step = kills/3 < 29 ? kills/3 : 29;
+
+	//dynamically generate enemies based on the number of kills
+	//every third kill will cause the enmies to spawn faster, down to one enemy per tick
+	if (spawnCount % (30 - step) == 0) {
+		generateEnemy();
+	}
+	for (i = 0; i < enemyCount; i++) {
+		//move each enemy on the board
+		moveEnemy(i);
+	}
+	spawnCount++;
+}
+
+void updateBullets(int fire){
+	// function for one tick of the bullet task, fires a bullet first if fire is set
+	int i;
+	if (fire) {
+		fireBullet();
+	}
+	//move each bullet on the screen
+	for (i = 0; i < bulletCount; i++) {
+		moveBullet(i);
+	}
+}
@@ -0,0 +1,122 @@
+#ifndef _GAME_H
+#define _GAME_H
+
+#include <stdint.h>
+#include "queue.h"
+#include "trig.h"
+
+// Declare width of LCD
+#ifndef WIDTH
+    #define WIDTH 320
+#endif
+
+//Declare Height of LCD
+#ifndef HEIGHT
+    #define HEIGHT 240
+#endif
+
+#define DEADPOINTLOC 100000
+
+// size of the enemy and bullet arrays
+#define MAX_ENEMIES 20
+#define MAX_BULLETS 20
+
+// lives of the player at the start of a game
+#define START_LIVES 3
+
+// number of player angle steps over the 12 bit pot range, a power of two
+#ifndef POT_STEPS
+    #define POT_STEPS 128
+#endif
+
+// pot counts the filtered value has to move past the edge of the current step
+// before the player angle changes
+#ifndef POT_HYSTERESIS
+    #define POT_HYSTERESIS 12
+#endif
+
+// the pot filter moves 1/2^POT_FILTER_SHIFT of the way to each new sample
+#ifndef POT_FILTER_SHIFT
+    #define POT_FILTER_SHIFT 2
+#endif
+
+// enum for the game states
+typedef enum {
+	GameOverScreen = 0,
+	GameScreen = 1
+}State;
+
+// declare struc for a point
+typedef struct {
+	int32_t x;
+	int32_t y;
+} point_t;
+
+//declare enemy struct, dx and dy are the unit direction in Q15
+typedef struct {
+	int32_t dx;
+	int32_t dy;
+	point_t point;
+	point_t prevPoint;
+	// set when the rasterized position changed since the last redraw
+	int dirty;
+} enemy_t;
+
+//declare bullet struct, dx and dy are the unit direction in Q15
+typedef struct {
+	int32_t dx;
+	int32_t dy;
+	point_t point;
+	point_t prevPoint;
+	// set when the rasterized position changed since the last redraw
+	int dirty;
+} bullet_t;
+
+// game state shared between the tasks
+extern node_t *enemyIndexHead;
+extern enemy_t enemies[MAX_ENEMIES];
+extern int enemyCount;
+extern int liveEnemies;
+
+extern node_t *bulletIndexHead;
+extern bullet_t bullets[MAX_BULLETS];
+extern int bulletCount;
+extern int liveBullets;
+
+extern angle_t prev_player_angle;
+extern angle_t player_angle;
+// set when the player angle changed since the last redraw
+extern int playerDirty;
+
+extern int kills;
+extern int lives;
+extern int difficulty;
+extern uint32_t spawnCount;
+extern uint32_t rngState;
+
+extern State gameState;
+
+// game random number generator, its state is part of the game state so a
+// snapshot restores the exact same sequence of enemies
+void gameSeed(uint32_t seed);
+int gameRand(void);
+
+void resetGame(void);
+angle_t potAngle(int potValue);
+// filter and quantize a 12 bit pot sample to a player angle step
+int potStep(int potValue);
+angle_t stepAngle(int step);
+void potReset(void);
+void setPlayerAngle(angle_t angle);
+void generateEnemy(void);
+void moveEnemy(int i);
+void moveBullet(int i);
+void fireBullet(void);
+int checkPlayerCollision(int index);
+int checkBulletCollision(int index);
+
+// one tick of the enemy and bullet tasks
+void updateEnemies(void);
+void updateBullets(int fire);
+
+#endif /* _GAME_H */
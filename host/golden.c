@@ -0,0 +1,464 @@
+/*----------------------------------------------------------------------------
+ * Name:    golden.c
+ * Purpose: Golden frame and SPI budget regression check (Linux)
+ * Note(s): Replays input recordings through game.c, render.c and the GLCD
+ *          driver. The SSP1 byte stream is decoded by the LCD emulator and
+ *          the emulated framebuffer is hashed at fixed ticks. The hashes and
+ *          the SPI bytes per frame are compared against the golden file, a
+ *          changed pixel or a frame that needs more bytes than the golden
+ *          budget plus the tolerance fails the run.
+ *
+ *          Build from the project directory, the build has to stay free
+ *          of warnings, with RENDER_TILED=0 and RENDER_SHADOW=0 as well:
+ *            gcc -O2 -Wall -Wextra -DGLCD_STATS=1 -Ihost -I. -o golden
+ *                host/golden.c host/lpc17xx.c host/lcdemu.c
+ *                GLCD_SPI_LPC1700.c game.c trig.c render.c sprites.c hud.c
+ *                bot.c queue.c -lm
+ *
+ *          Check:   golden host/recordings/<name>.rec ...
+ *          Update:  golden -u host/recordings/<name>.rec ...
+ *          Record:  golden -R host/recordings/new.rec -s seed -n ticks
+ *
+ *          -g sets the golden file (host/golden.txt), -t the byte budget
+ *          tolerance in percent (2), -k the ticks between two hashed frames
+ *          (100) and -o a directory that gets a PPM image of every frame
+ *          that does not match.
+ *
+ *          A recording starts with "seed <n>", every following line holds
+ *          "<ticks> <pot> <button>": the 12 bit pot value and the button
+ *          state held for that many ticks. The pot value goes through the
+ *          same filter and quantization as getPlayerAngle.
+ *----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include "GLCD.h"
+#include "game.h"
+#include "render.h"
+#include "hud.h"
+#include "bot.h"
+#include "lcdemu.h"
+
+#define MAX_STEPS    4096
+#define CLEAR_BUDGET (16 * 320 * 2)     // as RenderTask in main.c
+#define MAX_GOLDEN   1024
+#define MAX_NAME     64
+
+typedef struct {
+	uint32_t ticks;
+	int pot;
+	int button;
+} step_t;
+
+typedef struct {
+	uint32_t seed;
+	uint32_t count;
+	step_t steps[MAX_STEPS];
+} recording_t;
+
+typedef struct {
+	char rec[MAX_NAME];
+	char tick[16];
+	char value[32];
+	int seen;
+} golden_t;
+
+static const char *optGolden = "host/golden.txt";
+static const char *optImages = NULL;
+static double optTolerance = 2.0;
+static uint32_t optInterval = 100;
+static int optUpdate = 0;
+
+static recording_t rec;
+static golden_t golden[MAX_GOLDEN];
+static uint32_t goldenCount = 0;
+static int failures = 0;
+static FILE *update = NULL;
+
+/*----------------------------------------------------------------------------
+  Framebuffer hash and dump
+ *----------------------------------------------------------------------------*/
+static uint32_t frameHash(void) {
+	uint32_t h = 2166136261u;
+	uint16_t p;
+	unsigned int x, y;
+
+	// FNV-1a over the pixels in screen order
+	for (y = 0; y < HEIGHT; y++) {
+		for (x = 0; x < WIDTH; x++) {
+			p = lcdemuPixel(x, y);
+			h = (h ^ (p & 0xFF)) * 16777619u;
+			h = (h ^ (p >> 8)) * 16777619u;
+		}
+	}
+	return h;
+}
+
+static void dumpFrame(const char *name, const char *tick) {
+	char path[512];
+	unsigned int x, y;
+	uint16_t p;
+	FILE *f;
+
+	snprintf(path, sizeof(path), "%s/%s-%s.ppm", optImages, name, tick);
+	f = fopen(path, "wb");
+	if (!f) {
+		perror(path);
+		return;
+	}
+	fprintf(f, "P6\n%d %d\n255\n", WIDTH, HEIGHT);
+	for (y = 0; y < HEIGHT; y++) {
+		for (x = 0; x < WIDTH; x++) {
+			// RGB565 to 8 bits per channel
+			p = lcdemuPixel(x, y);
+			fputc(((p >> 11) & 0x1F) * 255 / 31, f);
+			fputc(((p >> 5) & 0x3F) * 255 / 63, f);
+			fputc((p & 0x1F) * 255 / 31, f);
+		}
+	}
+	fclose(f);
+	printf("  wrote %s\n", path);
+}
+
+/*----------------------------------------------------------------------------
+  Golden file
+ *----------------------------------------------------------------------------*/
+static void loadGolden(void) {
+	char line[256];
+	golden_t *g;
+	FILE *f = fopen(optGolden, "r");
+
+	if (!f) {
+		return;
+	}
+	while (fgets(line, sizeof(line), f) && goldenCount < MAX_GOLDEN) {
+		g = &golden[goldenCount];
+		if (line[0] == '#') {
+			continue;
+		}
+		if (sscanf(line, "frame %63s %15s %31s", g->rec, g->tick, g->value) == 3) {
+			goldenCount++;
+		}
+		else if (sscanf(line, "budget %63s %31s", g->rec, g->value) == 2) {
+			// budget lines are kept under the tick name "budget"
+			strcpy(g->tick, "budget");
+			goldenCount++;
+		}
+	}
+	fclose(f);
+}
+
+static golden_t *findGolden(const char *name, const char *tick) {
+	uint32_t i;
+
+	for (i = 0; i < goldenCount; i++) {
+		if (strcmp(golden[i].rec, name) == 0 && strcmp(golden[i].tick, tick) == 0) {
+			golden[i].seen = 1;
+			return &golden[i];
+		}
+	}
+	return NULL;
+}
+
+static void checkFrame(const char *name, const char *tick) {
+	char value[32];
+	golden_t *g;
+
+	snprintf(value, sizeof(value), "%08x", frameHash());
+	if (update) {
+		fprintf(update, "frame %s %s %s\n", name, tick, value);
+		return;
+	}
+	g = findGolden(name, tick);
+	if (!g) {
+		printf("  %s tick %s: no golden frame\n", name, tick);
+		failures++;
+	}
+	else if (strcmp(g->value, value) != 0) {
+		printf("  %s tick %s: frame %s, golden %s\n", name, tick, value, g->value);
+		failures++;
+	}
+	else {
+		return;
+	}
+	if (optImages) {
+		dumpFrame(name, tick);
+	}
+}
+
+static void checkBudget(const char *name, uint32_t peak, uint64_t total) {
+	unsigned int goldPeak;
+	unsigned long long goldTotal;
+	golden_t *g;
+
+	if (update) {
+		fprintf(update, "budget %s %u/%llu\n", name, peak, (unsigned long long)total);
+		return;
+	}
+	g = findGolden(name, "budget");
+	if (!g || sscanf(g->value, "%u/%llu", &goldPeak, &goldTotal) != 2) {
+		printf("  %s: no golden SPI budget\n", name);
+		failures++;
+		return;
+	}
+	if (peak > goldPeak * (1 + optTolerance / 100)) {
+		printf("  %s: peak %u SPI bytes per frame, budget %u\n", name, peak, goldPeak);
+		failures++;
+	}
+	if (total > goldTotal * (1 + optTolerance / 100)) {
+		printf("  %s: %llu SPI bytes in total, budget %llu\n", name, (unsigned long long)total, goldTotal);
+		failures++;
+	}
+	if (peak < goldPeak || total < goldTotal) {
+		printf("  %s: SPI bytes below budget (%u/%llu), update the golden file\n",
+		       name, peak, (unsigned long long)total);
+	}
+}
+
+/*----------------------------------------------------------------------------
+  Recordings
+ *----------------------------------------------------------------------------*/
+static int loadRecording(const char *path) {
+	char line[128];
+	step_t *s;
+	FILE *f = fopen(path, "r");
+
+	if (!f) {
+		perror(path);
+		return 0;
+	}
+	rec.count = 0;
+	if (!fgets(line, sizeof(line), f) || sscanf(line, "seed %u", &rec.seed) != 1) {
+		fprintf(stderr, "%s: missing seed line\n", path);
+		fclose(f);
+		return 0;
+	}
+	while (fgets(line, sizeof(line), f) && rec.count < MAX_STEPS) {
+		s = &rec.steps[rec.count];
+		if (sscanf(line, "%u %d %d", &s->ticks, &s->pot, &s->button) == 3) {
+			rec.count++;
+		}
+	}
+	fclose(f);
+	return 1;
+}
+
+static const char *baseName(const char *path) {
+	static char name[MAX_NAME];
+	const char *b = strrchr(path, '/');
+	char *dot;
+
+	snprintf(name, sizeof(name), "%s", b ? b + 1 : path);
+	dot = strrchr(name, '.');
+	if (dot) {
+		*dot = 0;
+	}
+	return name;
+}
+
+// title screen of initialize, then the game screen, the step clears are sent
+// to the end as the button wait and RenderTask do before anything else is drawn
+static void drawTitle(void) {
+	GLCD_SetBackColor(Black);
+	GLCD_SetTextColor(White);
+	GLCD_DisplayString(2, 5, 1, (unsigned char *)"SPACE NUTZ");
+	GLCD_DisplayString(4, 5, 1, (unsigned char *)"Press Button");
+}
+
+static void titleScreen(void) {
+	GLCD_Init();
+	GLCD_ClearStart(Black, drawTitle);
+	while (GLCD_ClearStep(CLEAR_BUDGET)) {
+	}
+}
+
+static void beginGame(uint32_t seed) {
+	resetGame();
+	gameSeed(seed);
+	renderReset();
+	GLCD_ClearStart(Black, hudReset);
+	while (GLCD_ClearStep(CLEAR_BUDGET)) {
+	}
+}
+
+// one tick in the order of the RTX tasks, returns the SPI bytes of the frame
+static uint32_t runTick(angle_t angle, int button, int *previous) {
+	uint32_t before;
+
+	setPlayerAngle(angle);
+	updateEnemies();
+	updateBullets(button && !*previous);
+	*previous = button;
+
+	before = GLCD_Stats.bytes;
+	renderFrame();
+	hudUpdate(0);
+	if (lives <= 0) {
+		gameState = GameOverScreen;
+		renderGameOver();
+		while (GLCD_ClearStep(CLEAR_BUDGET)) {
+		}
+	}
+	return GLCD_Stats.bytes - before;
+}
+
+static void replay(const char *path) {
+	const char *name;
+	char tick[16];
+	uint32_t i, j, t = 0;
+	uint32_t bytes, peak = 0;
+	uint64_t total = 0;
+	int previous = 0;
+	renderstats_t drawn = renderStats;
+
+	if (!loadRecording(path)) {
+		failures++;
+		return;
+	}
+	name = baseName(path);
+	printf("%s: seed %u\n", name, rec.seed);
+
+	lcdemuReset();
+	titleScreen();
+	checkFrame(name, "title");
+	beginGame(rec.seed);
+	prev_player_angle = rec.count ? stepAngle(potStep(rec.steps[0].pot)) : 0;
+
+	for (i = 0; i < rec.count && lives > 0; i++) {
+		for (j = 0; j < rec.steps[i].ticks && lives > 0; j++) {
+			bytes = runTick(stepAngle(potStep(rec.steps[i].pot)), rec.steps[i].button, &previous);
+			t++;
+			total += bytes;
+			// the game over screen is a full redraw, it has its own checkpoint
+			if (lives > 0 && bytes > peak) {
+				peak = bytes;
+			}
+			if (t % optInterval == 0 && lives > 0) {
+				snprintf(tick, sizeof(tick), "%u", t);
+				checkFrame(name, tick);
+			}
+		}
+	}
+	checkFrame(name, "end");
+	checkBudget(name, peak, total);
+	printf("  %u ticks, %d kills, %d lives, peak %u SPI bytes per frame, %llu total\n",
+	       t, kills, lives, peak, (unsigned long long)total);
+	drawn.redrawn = renderStats.redrawn - drawn.redrawn;
+	drawn.skipped = renderStats.skipped - drawn.skipped;
+	printf("  %u entity redraws, %u skipped (%.1f%%)\n", drawn.redrawn, drawn.skipped,
+	       drawn.redrawn + drawn.skipped ? 100.0 * drawn.skipped / (drawn.redrawn + drawn.skipped) : 0.0);
+}
+
+/*----------------------------------------------------------------------------
+  Record a bot game, the bot angle is turned into the pot value that gives
+  the nearest angle so the recording replays exactly
+ *----------------------------------------------------------------------------*/
+static int angleToPot(angle_t angle) {
+	int pot = (int)floor((4095 - angle * 585.0 / 64) / 2 + 0.5);
+
+	return pot < 0 ? 0 : pot > 4095 ? 4095 : pot;
+}
+
+static int record(const char *path, uint32_t seed, uint32_t ticks) {
+	FILE *f = fopen(path, "w");
+	uint32_t t, run = 0;
+	int pot, button, lastPot = -1, lastButton = 0;
+	int previous = 0;
+
+	if (!f) {
+		perror(path);
+		return 1;
+	}
+	fprintf(f, "seed %u\n", seed);
+	lcdemuReset();
+	beginGame(seed);
+	botReset();
+	prev_player_angle = stepAngle(potStep(angleToPot(botAngle())));
+
+	for (t = 0; t < ticks && lives > 0; t++) {
+		pot = angleToPot(botAngle());
+		button = botButton();
+		if (run && (pot != lastPot || button != lastButton)) {
+			fprintf(f, "%u %d %d\n", run, lastPot, lastButton);
+			run = 0;
+		}
+		lastPot = pot;
+		lastButton = button;
+		run++;
+		runTick(stepAngle(potStep(pot)), button, &previous);
+	}
+	if (run) {
+		fprintf(f, "%u %d %d\n", run, lastPot, lastButton);
+	}
+	fclose(f);
+	printf("%s: seed %u, %u ticks, %d kills, %d lives\n", path, seed, t, kills, lives);
+	return 0;
+}
+
+int main(int argc, char **argv) {
+	const char *recordPath = NULL;
+	uint32_t seed = BOT_SEED;
+	uint32_t ticks = 3000;
+	uint32_t i;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "ug:o:t:k:R:s:n:")) != -1) {
+		switch (opt) {
+			case 'u': optUpdate = 1; break;
+			case 'g': optGolden = optarg; break;
+			case 'o': optImages = optarg; break;
+			case 't': optTolerance = atof(optarg); break;
+			case 'k': optInterval = strtoul(optarg, NULL, 0); break;
+			case 'R': recordPath = optarg; break;
+			case 's': seed = strtoul(optarg, NULL, 0); break;
+			case 'n': ticks = strtoul(optarg, NULL, 0); break;
+			default:
+				fprintf(stderr, "usage: %s [-u] [-g golden] [-o dir] [-t percent] [-k ticks] recording...\n"
+				                "       %s -R recording [-s seed] [-n ticks]\n", argv[0], argv[0]);
+				return 2;
+		}
+	}
+	if (optInterval == 0) {
+		optInterval = 100;
+	}
+
+	if (recordPath) {
+		return record(recordPath, seed, ticks);
+	}
+	if (optind >= argc) {
+		fprintf(stderr, "no recordings given\n");
+		return 2;
+	}
+
+	if (optUpdate) {
+		update = fopen(optGolden, "w");
+		if (!update) {
+			perror(optGolden);
+			return 1;
+		}
+		fprintf(update, "# written by golden -u, frame <recording> <tick> <fnv1a>, budget <recording> <peak>/<total>\n");
+	}
+	else {
+		loadGolden();
+	}
+
+	for (i = optind; i < (uint32_t)argc; i++) {
+		replay(argv[i]);
+	}
+
+	if (update) {
+		fclose(update);
+		printf("updated %s\n", optGolden);
+		return 0;
+	}
+	for (i = 0; i < goldenCount; i++) {
+		if (!golden[i].seen) {
+			printf("  %s tick %s: golden entry not replayed\n", golden[i].rec, golden[i].tick);
+		}
+	}
+	printf("%s\n", failures ? "FAILED" : "passed");
+	return failures != 0;
+}
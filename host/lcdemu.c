@@ -0,0 +1,188 @@
+/*----------------------------------------------------------------------------
+ * Name:    lcdemu.c
+ * Purpose: Host emulation of the ILI932x LCD controller behind SSP1
+ * Note(s): Decodes the byte stream that GLCD_SPI_LPC1700.c shifts out while
+ *          the chip select is low, a 16 bit SSP1 frame (CR0 DSS) counts as
+ *          two bytes high byte first: the start byte selects regIndex or data and
+ *          write or read, the following bytes are taken in pairs. Data
+ *          written to regIndex 0x22 goes to the GRAM at the address counter,
+ *          which moves inside the window R50..R53 as set by the entry mode
+ *          register R03 (AM, I/D1, I/D0). Other data is stored in the
+ *          register file, reads return the register value after one dummy
+ *          byte. Only what the driver uses is emulated.
+ *----------------------------------------------------------------------------*/
+#include <string.h>
+#include "lpc17xx.h"
+#include "lcdemu.h"
+
+/* start byte fields                                                          */
+#define START_MASK  0xFC
+#define START_ID    0x70
+#define START_RD    0x01
+#define START_RS    0x02
+
+/* registers used by the emulation                                            */
+#define REG_ID      0x00
+#define REG_ENTRY   0x03
+#define REG_ADDR_H  0x20
+#define REG_ADDR_V  0x21
+#define REG_GRAM    0x22
+#define REG_H_START 0x50
+#define REG_H_END   0x51
+#define REG_V_START 0x52
+#define REG_V_END   0x53
+
+/* SSP1 receive FIFO not empty and data size select                          */
+#define SSP_RNE     0x04
+#define SSP_DSS     0x0F
+#define SSP_DSS_16  0x0F
+
+/* entry mode bits                                                            */
+#define ENTRY_ID0   0x0010
+#define ENTRY_ID1   0x0020
+#define ENTRY_AM    0x0008
+
+static uint16_t gram[LCDEMU_GRAM_V][LCDEMU_GRAM_H];
+static uint16_t regs[256];
+static unsigned int addrH, addrV;
+static unsigned int regIndex;
+static unsigned long writes;
+
+/* transaction state, reset whenever the chip select goes high                */
+static int csLow;
+static int count;                       /* bytes received since CS went low   */
+static int start;                       /* start byte of the transaction      */
+static unsigned int word;               /* high byte of the current pair      */
+static uint8_t rxByte;                  /* byte clocked in by the last write  */
+
+void lcdemuReset (void) {
+
+  memset(gram, 0, sizeof(gram));
+  memset(regs, 0, sizeof(regs));
+  regs[REG_ID]      = LCDEMU_ID;
+  regs[REG_ENTRY]   = ENTRY_ID1 | ENTRY_ID0;
+  regs[REG_H_END]   = LCDEMU_GRAM_H - 1;
+  regs[REG_V_END]   = LCDEMU_GRAM_V - 1;
+  addrH = addrV = 0;
+  regIndex = 0;
+  writes = 0;
+  csLow = 0;
+  count = 0;
+}
+
+uint16_t lcdemuPixel (unsigned int x, unsigned int y) {
+
+  /* landscape: the horizontal address is y, the vertical address is x       */
+  if (x >= LCDEMU_GRAM_V || y >= LCDEMU_GRAM_H)
+    return 0;
+  return gram[x][y];
+}
+
+uint16_t lcdemuReg (unsigned int reg) {
+
+  return regs[reg & 0xFF];
+}
+
+unsigned long lcdemuWrites (void) {
+
+  return writes;
+}
+
+/* step the address counter inside the window as the entry mode says          */
+static void nextAddr (void) {
+  unsigned int entry = regs[REG_ENTRY];
+  unsigned int hs = regs[REG_H_START], he = regs[REG_H_END];
+  unsigned int vs = regs[REG_V_START], ve = regs[REG_V_END];
+  int wrapH = 0, wrapV = 0;
+
+  if (entry & ENTRY_AM) {
+    /* vertical first, then one step horizontally at the end of a line       */
+    if (entry & ENTRY_ID1) { if (addrV >= ve) { addrV = vs; wrapV = 1; } else addrV++; }
+    else                   { if (addrV <= vs) { addrV = ve; wrapV = 1; } else addrV--; }
+    if (wrapV) {
+      if (entry & ENTRY_ID0) { if (addrH >= he) addrH = hs; else addrH++; }
+      else                   { if (addrH <= hs) addrH = he; else addrH--; }
+    }
+  }
+  else {
+    if (entry & ENTRY_ID0) { if (addrH >= he) { addrH = hs; wrapH = 1; } else addrH++; }
+    else                   { if (addrH <= hs) { addrH = he; wrapH = 1; } else addrH--; }
+    if (wrapH) {
+      if (entry & ENTRY_ID1) { if (addrV >= ve) addrV = vs; else addrV++; }
+      else                   { if (addrV <= vs) addrV = ve; else addrV--; }
+    }
+  }
+}
+
+static void writeData (unsigned int val) {
+
+  if (regIndex == REG_GRAM) {
+    if (addrH < LCDEMU_GRAM_H && addrV < LCDEMU_GRAM_V)
+      gram[addrV][addrH] = (uint16_t)val;
+    writes++;
+    nextAddr();
+    return;
+  }
+  regs[regIndex] = (uint16_t)val;
+  /* writing the address registers moves the counter                         */
+  if (regIndex == REG_ADDR_H) addrH = val;
+  if (regIndex == REG_ADDR_V) addrV = val;
+}
+
+void host_lcdCs (int level) {
+
+  if (level) {
+    csLow = 0;
+  }
+  else if (!csLow) {
+    csLow = 1;
+    count = 0;
+  }
+}
+
+static void shiftByte (uint8_t b) {
+  unsigned int n;
+
+  rxByte = 0;
+  if (!csLow)
+    return;
+  if (count++ == 0) {
+    start = ((b & START_MASK) == START_ID) ? b : -1;
+    return;
+  }
+  if (start < 0)
+    return;
+
+  if (start & START_RD) {
+    /* one dummy byte, then the register value high byte first              */
+    n = regs[regIndex];
+    if (count == 3) rxByte = (uint8_t)(n >> 8);
+    if (count == 4) rxByte = (uint8_t)(n & 0xFF);
+    return;
+  }
+  if (count & 1) {
+    word = (word << 8) | b;
+    if (start & START_RS)
+      writeData(word & 0xFFFF);
+    else
+      regIndex = word & 0xFF;
+  }
+  else {
+    word = b;
+  }
+}
+
+void host_sspTx (uint32_t val) {
+
+  if ((LPC_SSP1->CR0 & SSP_DSS) == SSP_DSS_16) {
+    shiftByte((uint8_t)(val >> 8));
+  }
+  shiftByte((uint8_t)val);
+  LPC_SSP1->SR |= SSP_RNE;
+}
+
+uint32_t host_sspRx (void) {
+
+  LPC_SSP1->SR &= ~SSP_RNE;
+  return rxByte;
+}
@@ -0,0 +1,29 @@
+/*----------------------------------------------------------------------------
+ * Name:    lcdemu.h
+ * Purpose: Host emulation of the ILI932x LCD controller behind SSP1
+ *----------------------------------------------------------------------------*/
+#ifndef _LCDEMU_H
+#define _LCDEMU_H
+
+#include <stdint.h>
+
+/* GRAM size of the controller, 240 horizontal by 320 vertical addresses     */
+#define LCDEMU_GRAM_H 240
+#define LCDEMU_GRAM_V 320
+
+/* controller id returned for register 0x00                                   */
+#define LCDEMU_ID     0x9325
+
+/* put the controller back into its power-on state and clear the GRAM         */
+void lcdemuReset (void);
+
+/* pixel at screen position x, y for the landscape orientation of GLCD_Init   */
+uint16_t lcdemuPixel (unsigned int x, unsigned int y);
+
+/* current value of a controller register                                     */
+uint16_t lcdemuReg (unsigned int reg);
+
+/* number of GRAM writes since the last reset                                 */
+unsigned long lcdemuWrites (void);
+
+#endif /* _LCDEMU_H */
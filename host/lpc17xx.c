@@ -0,0 +1,16 @@
+/*----------------------------------------------------------------------------
+ * Name:    lpc17xx.c
+ * Purpose: Host stand-in for the LPC17xx peripherals, see lpc17xx.h
+ *----------------------------------------------------------------------------*/
+#include "lpc17xx.h"
+
+/* SSP1 status: transmit FIFO empty and not full, receive FIFO not empty      */
+#define SSP_SR_IDLE 0x07
+
+LPC_GPIO_TypeDef   host_GPIO0;
+LPC_GPIO_TypeDef   host_GPIO4;
+LPC_SSP_TypeDef    host_SSP1 = { 0, 0, 0, SSP_SR_IDLE, 0, 0, 0, 0, 0, 0 };
+LPC_SC_TypeDef     host_SC;
+LPC_PINCON_TypeDef host_PINCON;
+
+uint32_t SystemCoreClock = 100000000;
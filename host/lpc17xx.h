@@ -0,0 +1,73 @@
+/*----------------------------------------------------------------------------
+ * Name:    lpc17xx.h
+ * Purpose: Host stand-in for the LPC17xx device header
+ * Note(s): Only the peripherals used by the GLCD driver and the SPI cost
+ *          model are provided. The registers are plain memory, SSP1 always
+ *          reports that a transfer has finished, the receive FIFO holds the
+ *          byte of the last transfer until it is read. The data register and
+ *          the LCD chip select are routed to the LCD emulator (lcdemu.c).
+ *          Put the host directory in front of the include path so this file
+ *          is found instead of the Keil one.
+ *----------------------------------------------------------------------------*/
+#ifndef __LPC17xx_H__
+#define __LPC17xx_H__
+
+#include <stdint.h>
+
+#define HOST_BUILD  1
+
+typedef struct {
+  volatile uint32_t FIODIR;
+           uint32_t RESERVED0[3];
+  volatile uint32_t FIOMASK;
+  volatile uint32_t FIOPIN;
+  volatile uint32_t FIOSET;
+  volatile uint32_t FIOCLR;
+} LPC_GPIO_TypeDef;
+
+typedef struct {
+  volatile uint32_t CR0;
+  volatile uint32_t CR1;
+  volatile uint32_t DR;
+  volatile uint32_t SR;
+  volatile uint32_t CPSR;
+  volatile uint32_t IMSC;
+  volatile uint32_t RIS;
+  volatile uint32_t MIS;
+  volatile uint32_t ICR;
+  volatile uint32_t DMACR;
+} LPC_SSP_TypeDef;
+
+typedef struct {
+  volatile uint32_t PCONP;
+  volatile uint32_t PCLKSEL0;
+  volatile uint32_t PCLKSEL1;
+} LPC_SC_TypeDef;
+
+typedef struct {
+  volatile uint32_t PINSEL0;
+  volatile uint32_t PINSEL1;
+  volatile uint32_t PINSEL9;
+  volatile uint32_t PINMODE0;
+} LPC_PINCON_TypeDef;
+
+extern LPC_GPIO_TypeDef   host_GPIO0;
+extern LPC_GPIO_TypeDef   host_GPIO4;
+extern LPC_SSP_TypeDef    host_SSP1;
+extern LPC_SC_TypeDef     host_SC;
+extern LPC_PINCON_TypeDef host_PINCON;
+
+#define LPC_GPIO0   (&host_GPIO0)
+#define LPC_GPIO4   (&host_GPIO4)
+#define LPC_SSP1    (&host_SSP1)
+#define LPC_SC      (&host_SC)
+#define LPC_PINCON  (&host_PINCON)
+
+extern uint32_t SystemCoreClock;
+
+/* LCD bus as seen by the GLCD driver, implemented by the LCD emulator        */
+void     host_sspTx (uint32_t val);
+uint32_t host_sspRx (void);
+void     host_lcdCs (int level);
+
+#endif /* __LPC17xx_H__ */
@@ -0,0 +1,277 @@
+/*----------------------------------------------------------------------------
+ * Name:    rlegen.c
+ * Purpose: Bitmap asset converter (Linux)
+ * Note(s): Turns a PPM image into the palette and run length coded stream
+ *          drawn by GLCD_BitmapRLE: name.h declares the const byte array,
+ *          name.c holds it in flash. The colors are reduced to RGB565, an
+ *          image may use up to 256 of them. Equal pixels in a row of three
+ *          or more become one run, runs go on over the row end so a plain
+ *          background is a few long fills. Other formats, PNG included, can
+ *          be turned into a PPM first, for example with
+ *            convert title.png title.ppm
+ *
+ *          Build and run from the project directory:
+ *            gcc -O2 -Wall -Wextra -o rlegen host/rlegen.c
+ *            ./rlegen title.ppm title
+ *
+ *          The raw and the coded size are printed, see GLCD_BitmapRLE for
+ *          the stream format.
+ *----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <ctype.h>
+
+#define MAX_COLORS  256
+#define MAX_SIDE    320
+#define MAX_LITERAL 128
+#define MAX_SHORT   127
+#define MAX_LONG    65535
+#define MIN_RUN     3
+#define LINE_BYTES  16              // array bytes per source line
+
+static unsigned short palette[MAX_COLORS];
+static int colorCount = 0;
+static unsigned char *pixels;           // palette index of every pixel, top row first
+static int width, height;
+
+static unsigned char *stream;
+static long streamSize = 0;
+
+/*----------------------------------------------------------------------------
+  Read the image, binary (P6) and plain (P3) PPM are accepted
+ *----------------------------------------------------------------------------*/
+static int readNumber(FILE *f) {
+	int c, n = 0;
+
+	do {
+		c = fgetc(f);
+		if (c == '#') {
+			while (c != EOF && c != '\n') {
+				c = fgetc(f);
+			}
+		}
+	} while (c != EOF && isspace(c));
+	if (!isdigit(c)) {
+		return -1;
+	}
+	while (isdigit(c)) {
+		n = n * 10 + c - '0';
+		c = fgetc(f);
+	}
+	return n;
+}
+
+static int colorIndex(const char *path, unsigned short color) {
+	int i;
+
+	for (i = 0; i < colorCount; i++) {
+		if (palette[i] == color) {
+			return i;
+		}
+	}
+	if (colorCount == MAX_COLORS) {
+		fprintf(stderr, "%s: more than %d colors after the reduction to RGB565\n", path, MAX_COLORS);
+		return -1;
+	}
+	palette[colorCount] = color;
+	return colorCount++;
+}
+
+static int readImage(const char *path) {
+	int plain, maxval, i, j, c, rgb[3];
+	FILE *f = fopen(path, "rb");
+
+	if (!f) {
+		perror(path);
+		return 0;
+	}
+	if (fgetc(f) != 'P' || ((c = fgetc(f)) != '6' && c != '3')) {
+		fprintf(stderr, "%s: not a PPM image\n", path);
+		fclose(f);
+		return 0;
+	}
+	plain = c == '3';
+	width = readNumber(f);
+	height = readNumber(f);
+	maxval = readNumber(f);
+	if (width <= 0 || height <= 0 || maxval <= 0 || maxval > 255) {
+		fprintf(stderr, "%s: unsupported PPM header\n", path);
+		fclose(f);
+		return 0;
+	}
+	if (width > MAX_SIDE || height > MAX_SIDE) {
+		fprintf(stderr, "%s: %dx%d is larger than the screen\n", path, width, height);
+		fclose(f);
+		return 0;
+	}
+	pixels = malloc((size_t)width * height);
+	for (i = 0; i < width * height; i++) {
+		for (j = 0; j < 3; j++) {
+			rgb[j] = plain ? readNumber(f) : fgetc(f);
+			if (rgb[j] < 0 || rgb[j] > maxval) {
+				fprintf(stderr, "%s: image data ends early\n", path);
+				fclose(f);
+				return 0;
+			}
+			rgb[j] = (rgb[j] * 255 + maxval / 2) / maxval;
+		}
+		c = colorIndex(path, (unsigned short)(((rgb[0] >> 3) << 11) | ((rgb[1] >> 2) << 5) | (rgb[2] >> 3)));
+		if (c < 0) {
+			fclose(f);
+			return 0;
+		}
+		pixels[i] = (unsigned char)c;
+	}
+	fclose(f);
+	return 1;
+}
+
+/*----------------------------------------------------------------------------
+  Code the image, a run of MIN_RUN equal pixels costs two bytes against
+  three in a literal, shorter ones are kept in the literal
+ *----------------------------------------------------------------------------*/
+static void put(int byte) {
+	stream[streamSize++] = (unsigned char)byte;
+}
+
+static void putLiteral(int from, int to) {
+	int n;
+
+	while (from < to) {
+		n = to - from > MAX_LITERAL ? MAX_LITERAL : to - from;
+		put(n - 1);
+		while (n--) {
+			put(pixels[from++]);
+		}
+	}
+}
+
+static void encode(void) {
+	int i, total = width * height, literal = 0, run;
+
+	// worst case is one code byte for every MAX_LITERAL pixels on top of the indexes
+	stream = malloc(5 + 2 * MAX_COLORS + total + total / MAX_LITERAL + 1);
+	put(width & 0xFF);
+	put(width >> 8);
+	put(height & 0xFF);
+	put(height >> 8);
+	put(colorCount - 1);
+	for (i = 0; i < colorCount; i++) {
+		put(palette[i] & 0xFF);
+		put(palette[i] >> 8);
+	}
+	i = 0;
+	while (i < total) {
+		run = 1;
+		while (i + run < total && pixels[i + run] == pixels[i] && run < MAX_LONG) {
+			run++;
+		}
+		if (run < MIN_RUN) {
+			i += run;
+			continue;
+		}
+		putLiteral(literal, i);
+		if (run > MAX_SHORT) {
+			put(0xFF);
+			put(run & 0xFF);
+			put(run >> 8);
+		} else {
+			put(0x80 | (run - 1));
+		}
+		put(pixels[i]);
+		i += run;
+		literal = i;
+	}
+	putLiteral(literal, total);
+}
+
+/*----------------------------------------------------------------------------
+  Write the array, the project sources use DOS line endings
+ *----------------------------------------------------------------------------*/
+static void writeLine(FILE *f, const char *fmt, ...) {
+	va_list ap;
+
+	va_start(ap, fmt);
+	vfprintf(f, fmt, ap);
+	va_end(ap);
+	fputs("\r\n", f);
+}
+
+static int writeHeader(const char *name, const char *image) {
+	char path[FILENAME_MAX];
+	char guard[FILENAME_MAX];
+	int i;
+	FILE *f;
+
+	snprintf(path, sizeof(path), "%s.h", name);
+	f = fopen(path, "wb");
+	if (!f) {
+		perror(path);
+		return 0;
+	}
+	for (i = 0; name[i] && i < FILENAME_MAX - 4; i++) {
+		guard[i] = isalnum((unsigned char)name[i]) ? toupper((unsigned char)name[i]) : '_';
+	}
+	guard[i] = 0;
+	writeLine(f, "// generated by host/rlegen.c from %s, do not edit", image);
+	writeLine(f, "#ifndef _%s_H", guard);
+	writeLine(f, "#define _%s_H", guard);
+	writeLine(f, "");
+	writeLine(f, "// %dx%d pixels, %d colors, draw with GLCD_BitmapRLE", width, height, colorCount);
+	writeLine(f, "extern const unsigned char %s[%ld];", name, streamSize);
+	writeLine(f, "");
+	writeLine(f, "#endif");
+	fclose(f);
+	return 1;
+}
+
+static int writeSource(const char *name, const char *image) {
+	char path[FILENAME_MAX];
+	char buf[LINE_BYTES * 6 + 2];
+	long i, n;
+	FILE *f;
+
+	snprintf(path, sizeof(path), "%s.c", name);
+	f = fopen(path, "wb");
+	if (!f) {
+		perror(path);
+		return 0;
+	}
+	writeLine(f, "// generated by host/rlegen.c from %s, do not edit", image);
+	writeLine(f, "#include \"%s.h\"", name);
+	writeLine(f, "");
+	writeLine(f, "const unsigned char %s[%ld] = {", name, streamSize);
+	for (i = 0; i < streamSize; i += LINE_BYTES) {
+		buf[0] = 0;
+		for (n = i; n < streamSize && n < i + LINE_BYTES; n++) {
+			snprintf(buf + strlen(buf), sizeof(buf) - strlen(buf), "%s0x%02X%s",
+			         n == i ? "\t" : " ", stream[n], n + 1 < streamSize ? "," : "");
+		}
+		writeLine(f, "%s", buf);
+	}
+	writeLine(f, "};");
+	fclose(f);
+	return 1;
+}
+
+int main(int argc, char **argv) {
+	long raw;
+
+	if (argc != 3) {
+		fprintf(stderr, "usage: rlegen image.ppm name\n");
+		return 2;
+	}
+	if (!readImage(argv[1])) {
+		return 1;
+	}
+	encode();
+	if (!writeHeader(argv[2], argv[1]) || !writeSource(argv[2], argv[1])) {
+		return 1;
+	}
+	raw = 2L * width * height;
+	printf("%s: %dx%d, %d colors, %ld bytes raw, %ld bytes coded (%.1fx)\n", argv[2], width, height,
+	       colorCount, raw, streamSize, (double)raw / streamSize);
+	return 0;
+}
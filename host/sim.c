@@ -0,0 +1,578 @@
+/*----------------------------------------------------------------------------
+ * Name:    sim.c
+ * Purpose: Headless batch simulator for difficulty and load sweeps (Linux)
+ * Note(s): Runs many seeded games in parallel on all CPU cores and reports
+ *          the distribution of the peak entity counts and of the estimated
+ *          SPI traffic and frame time. Each game runs the same game.c,
+ *          render.c and GLCD driver code as the target, the SSP1 traffic is
+ *          counted by the driver and turned into a predicted frame time by
+ *          the SPI cost model.
+ *
+ *          Build from the project directory, the build has to stay free
+ *          of warnings:
+ *            gcc -O2 -Wall -Wextra -DGLCD_STATS=1 -Ihost -I. -o sim
+ *                host/sim.c host/lpc17xx.c host/lcdemu.c GLCD_SPI_LPC1700.c
+ *                spicost.c game.c trig.c render.c sprites.c hud.c bot.c
+ *                queue.c snapshot.c -lm
+ *
+ *          Usage: sim [-n games] [-j workers] [-s seed] [-t ticks] [-b]
+ *                     [-f fire period] [-T] [-l start.snap] [-c per-game.csv]
+ *                     [-d worst.snap] [-B]
+ *
+ *          -b replaces the scripted pot sweep by the aiming bot and prints
+ *          its hit rate per difficulty level, -T is the self test: the bot
+ *          runs and the exit status is 1 when the hit rate of a higher
+ *          level falls well below level 1 or when the games come out
+ *          different on one worker. -l starts every game from a
+ *          snapshot (reseeded with the game seed), -B only prints the
+ *          predicted cost of the sprite draw routines.
+ *----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stddef.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <time.h>
+#include "GLCD.h"
+#include "game.h"
+#include "render.h"
+#include "hud.h"
+#include "snapshot.h"
+#include "bot.h"
+#include "spicost.h"
+
+#define MAX_WORKERS 256
+
+// frame time budgets for 30 and 60 frames per second
+#define BUDGET_30HZ_US 33333
+#define BUDGET_60HZ_US 16667
+
+// the pot range of getPlayerAngle, +/-157.5 degrees in binary angle units
+#define ANGLE_RANGE (ANGLE_STEPS * 7 / 16)
+
+// difficulty levels the shots and hits are counted for, higher levels go in the last one
+#define HIT_LEVELS 16
+
+// the self test only rates a level with this many shots, and fails when its hit
+// rate is below HIT_KEEP_PERCENT of the level 1 rate
+#define HIT_MIN_SHOTS    200
+#define HIT_KEEP_PERCENT 80
+
+typedef struct {
+	uint32_t seed;
+	uint32_t ticks;
+	uint32_t kills;
+	uint32_t difficulty;
+	uint32_t peakEnemies;
+	uint32_t peakBullets;
+	uint32_t peakSpiBytes;
+	uint32_t meanSpiBytes;
+	uint32_t peakFrameUs;
+	uint32_t meanFrameUs;
+	uint32_t over30Hz;
+	uint32_t over60Hz;
+	uint32_t redrawn;
+	uint32_t skipped;
+	uint32_t shots[HIT_LEVELS];
+	uint32_t hits[HIT_LEVELS];
+} result_t;
+
+typedef struct {
+	// packed range of game numbers still owned by the worker, low word first, high word last
+	volatile uint64_t range;
+	// worst state seen by the worker
+	uint32_t worstEnemies;
+	uint32_t worstSize;
+	unsigned char worst[SNAPSHOT_MAX_SIZE];
+	char pad[64];
+} worker_t;
+
+typedef struct {
+	angle_t angle;
+	int button;
+} input_t;
+
+static uint32_t optGames = 1000;
+static uint32_t optWorkers = 0;
+static uint32_t optSeed = 2000000;
+static uint32_t optTicks = 20000;
+static uint32_t optFirePeriod = 8;
+static int optBot = 0;
+static int optTest = 0;
+
+static unsigned char startState[SNAPSHOT_MAX_SIZE];
+static unsigned int startSize = 0;
+
+static result_t *results;
+static worker_t *workers;
+
+/*----------------------------------------------------------------------------
+  Scripted input policy: sweep the pot across its range and tap the button
+ *----------------------------------------------------------------------------*/
+static void scriptedInput(uint32_t tick, input_t *in) {
+	uint32_t period = 400;
+	uint32_t phase = tick % period;
+	double t = phase < period/2 ? (double)phase/(period/2) : (double)(period - phase)/(period/2);
+
+	in->angle = (angle_t)(ANGLE_RANGE * (2*t - 1));
+	in->button = (tick % optFirePeriod) == 0;
+}
+
+/*----------------------------------------------------------------------------
+  Bot input policy: aim at the nearest enemy and fire every optFirePeriod ticks
+ *----------------------------------------------------------------------------*/
+static void botInput(uint32_t tick, input_t *in) {
+	(void)tick;
+	in->angle = botAngle();
+	in->button = botButton();
+}
+
+/*----------------------------------------------------------------------------
+  Run one game, mirrors the order of the RTX tasks for each frame
+ *----------------------------------------------------------------------------*/
+static void runGame(uint32_t seed, result_t *r, worker_t *w) {
+	void (*policy)(uint32_t tick, input_t *in) = optBot ? botInput : scriptedInput;
+	input_t in;
+	int previous = 0;
+	uint32_t tick;
+	uint64_t totalBytes = 0;
+	uint64_t totalUs = 0;
+	uint32_t bytes;
+	uint32_t us;
+	uint32_t level;
+	int shot;
+	int killed;
+	GLCD_STATS_T before;
+	renderstats_t drawn = renderStats;
+
+	memset(r, 0, sizeof(*r));
+	r->seed = seed;
+
+	// every game starts on a freshly set up and cleared LCD, so its traffic does
+	// not depend on the games the worker ran before it
+	GLCD_Init();
+	GLCD_Clear(Black);
+	renderReset();
+	resetGame();
+	if (startSize) {
+		loadSnapshot(startState, startSize);
+	}
+	gameSeed(seed);
+	botReset();
+	hudReset();
+	prev_player_angle = optBot ? botAngle() : (scriptedInput(0, &in), in.angle);
+
+	for (tick = 0; tick < optTicks && lives > 0; tick++) {
+		policy(tick, &in);
+		setPlayerAngle(in.angle);
+		updateEnemies();
+		// a press fires unless fireBullet finds 16 bullets in flight
+		shot = in.button && !previous && liveBullets <= 15;
+		level = (uint32_t)difficulty < HIT_LEVELS ? (uint32_t)difficulty : HIT_LEVELS - 1;
+		killed = kills;
+		updateBullets(in.button && !previous);
+		previous = in.button;
+
+		before = GLCD_Stats;
+		renderFrame();
+		// the kills of the frame go to the level it started on, a shot lands a few ticks after it is fired
+		r->shots[level] += shot;
+		r->hits[level] += kills - killed;
+		hudUpdate(0);
+		bytes = GLCD_Stats.bytes - before.bytes;
+		us = spiCostMicros(&before, &GLCD_Stats);
+		totalBytes += bytes;
+		totalUs += us;
+
+		if (bytes > r->peakSpiBytes) {
+			r->peakSpiBytes = bytes;
+		}
+		if (us > r->peakFrameUs) {
+			r->peakFrameUs = us;
+		}
+		r->over30Hz += us > BUDGET_30HZ_US;
+		r->over60Hz += us > BUDGET_60HZ_US;
+		if ((uint32_t)liveBullets > r->peakBullets) {
+			r->peakBullets = liveBullets;
+		}
+		if ((uint32_t)liveEnemies > r->peakEnemies) {
+			r->peakEnemies = liveEnemies;
+			// keep the most crowded state seen by this worker for benchmarks
+			if ((uint32_t)liveEnemies > w->worstEnemies) {
+				w->worstSize = saveSnapshot(w->worst, sizeof(w->worst));
+				w->worstEnemies = liveEnemies;
+			}
+		}
+	}
+	r->ticks = tick;
+	r->kills = kills;
+	r->difficulty = difficulty;
+	r->meanSpiBytes = tick ? (uint32_t)(totalBytes / tick) : 0;
+	r->meanFrameUs = tick ? (uint32_t)(totalUs / tick) : 0;
+	r->redrawn = renderStats.redrawn - drawn.redrawn;
+	r->skipped = renderStats.skipped - drawn.skipped;
+}
+
+/*----------------------------------------------------------------------------
+  Work stealing pool. Every worker owns a range of game numbers, it takes
+  games from the bottom of its range and an idle worker steals the top half
+  of the largest remaining range.
+ *----------------------------------------------------------------------------*/
+#define RANGE(lo, hi)   (((uint64_t)(hi) << 32) | (lo))
+#define RANGE_LO(r)     ((uint32_t)(r))
+#define RANGE_HI(r)     ((uint32_t)((r) >> 32))
+
+static int takeGame(worker_t *w, uint32_t *game) {
+	uint64_t r = __atomic_load_n(&w->range, __ATOMIC_ACQUIRE);
+
+	while (RANGE_LO(r) < RANGE_HI(r)) {
+		if (__atomic_compare_exchange_n(&w->range, &r, RANGE(RANGE_LO(r) + 1, RANGE_HI(r)),
+		                                0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+			*game = RANGE_LO(r);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static int steal(uint32_t self) {
+	uint32_t i;
+	uint32_t victim;
+	uint32_t best;
+	uint32_t half;
+	uint64_t r;
+
+	for (;;) {
+		best = 0;
+		victim = self;
+		for (i = 0; i < optWorkers; i++) {
+			r = __atomic_load_n(&workers[i].range, __ATOMIC_ACQUIRE);
+			if (i != self && RANGE_HI(r) - RANGE_LO(r) > best && RANGE_LO(r) < RANGE_HI(r)) {
+				best = RANGE_HI(r) - RANGE_LO(r);
+				victim = i;
+			}
+		}
+		if (victim == self) {
+			return 0;
+		}
+		r = __atomic_load_n(&workers[victim].range, __ATOMIC_ACQUIRE);
+		if (RANGE_LO(r) >= RANGE_HI(r)) {
+			continue;
+		}
+		half = (RANGE_HI(r) - RANGE_LO(r) + 1) / 2;
+		if (__atomic_compare_exchange_n(&workers[victim].range, &r, RANGE(RANGE_LO(r), RANGE_HI(r) - half),
+		                                0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+			__atomic_store_n(&workers[self].range, RANGE(RANGE_HI(r) - half, RANGE_HI(r)), __ATOMIC_RELEASE);
+			return 1;
+		}
+	}
+}
+
+static void worker(uint32_t self) {
+	uint32_t game;
+
+	// the SSP1 clock set up by GLCD_Init gives the cost of a bit
+	GLCD_Init();
+	spiCostInit();
+
+	do {
+		while (takeGame(&workers[self], &game)) {
+			runGame(optSeed + game, &results[game], &workers[self]);
+		}
+	} while (steal(self));
+}
+
+// play all games on the first count workers, returns the seconds taken or a
+// negative value when a worker cannot be started
+static double runBatch(uint32_t count) {
+	struct timespec t0, t1;
+	uint32_t i;
+	uint32_t per = optGames / count;
+
+	memset(workers, 0, optWorkers * sizeof(worker_t));
+	for (i = 0; i < count; i++) {
+		workers[i].range = RANGE(i * per, i == count - 1 ? optGames : (i + 1) * per);
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for (i = 0; i < count; i++) {
+		pid_t pid = fork();
+		if (pid == 0) {
+			worker(i);
+			_exit(0);
+		}
+		if (pid < 0) {
+			perror("fork");
+			return -1;
+		}
+	}
+	while (wait(NULL) > 0);
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	return (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+}
+
+// play the batch again on one worker, a game may not depend on the games run
+// before it by the same worker, returns 0 when any result differs
+static int checkOneWorker(void) {
+	result_t *batch = malloc(optGames * sizeof(result_t));
+	int same;
+
+	memcpy(batch, results, optGames * sizeof(result_t));
+	same = runBatch(1) >= 0 && memcmp(batch, results, optGames * sizeof(result_t)) == 0;
+	printf("\n%s input, %u workers and 1 worker give %s results\n", optBot ? "bot" : "scripted",
+	       optWorkers, same ? "the same" : "different");
+	free(batch);
+	return same;
+}
+
+/*----------------------------------------------------------------------------
+  Reporting
+ *----------------------------------------------------------------------------*/
+static size_t fieldOffset;
+
+static int cmpField(const void *a, const void *b) {
+	uint32_t va = *(const uint32_t *)((const char *)a + fieldOffset);
+	uint32_t vb = *(const uint32_t *)((const char *)b + fieldOffset);
+	return va < vb ? -1 : va > vb;
+}
+
+static void printDistribution(const char *name, size_t offset, result_t *sorted) {
+	uint64_t sum = 0;
+	uint32_t i;
+
+	fieldOffset = offset;
+	qsort(sorted, optGames, sizeof(result_t), cmpField);
+	for (i = 0; i < optGames; i++) {
+		sum += *(uint32_t *)((char *)&sorted[i] + offset);
+	}
+#define AT(p) (*(uint32_t *)((char *)&sorted[(uint32_t)((optGames - 1) * (p))] + offset))
+	printf("%-16s %8u %8u %8u %8u %8u %10.1f\n", name,
+	       AT(0.0), AT(0.5), AT(0.9), AT(0.99), AT(1.0), (double)sum / optGames);
+#undef AT
+}
+
+static void printHistogram(const char *name, size_t offset) {
+	uint32_t hist[MAX_ENEMIES + 1];
+	uint32_t i;
+	uint32_t v;
+
+	memset(hist, 0, sizeof(hist));
+	for (i = 0; i < optGames; i++) {
+		v = *(uint32_t *)((char *)&results[i] + offset);
+		hist[v <= MAX_ENEMIES ? v : MAX_ENEMIES]++;
+	}
+	printf("\n%s histogram\n", name);
+	for (i = 0; i <= MAX_ENEMIES; i++) {
+		if (hist[i]) {
+			printf("%4u %8u  %5.1f%%\n", i, hist[i], 100.0 * hist[i] / optGames);
+		}
+	}
+}
+
+// bot hit rate per difficulty level, the lead of botAngle has to keep it up as
+// the enemies get faster, returns 0 when a level falls below HIT_KEEP_PERCENT
+static int printHitRate(void) {
+	uint64_t shots[HIT_LEVELS];
+	uint64_t hits[HIT_LEVELS];
+	uint32_t i;
+	uint32_t l;
+	double base = 0;
+	double rate;
+	int ok = 1;
+
+	memset(shots, 0, sizeof(shots));
+	memset(hits, 0, sizeof(hits));
+	for (i = 0; i < optGames; i++) {
+		for (l = 0; l < HIT_LEVELS; l++) {
+			shots[l] += results[i].shots[l];
+			hits[l] += results[i].hits[l];
+		}
+	}
+	printf("\nhit rate by difficulty\n");
+	for (l = 1; l < HIT_LEVELS; l++) {
+		if (shots[l] == 0) {
+			continue;
+		}
+		rate = (double)hits[l] / shots[l];
+		if (l == 1) {
+			base = rate;
+		}
+		printf("%4u%s %8llu shots %5.1f%%", l, l == HIT_LEVELS - 1 ? "+" : " ",
+		       (unsigned long long)shots[l], 100.0 * rate);
+		if (shots[l] >= HIT_MIN_SHOTS && rate * 100 < base * HIT_KEEP_PERCENT) {
+			printf("  below %u%% of level 1", HIT_KEEP_PERCENT);
+			ok = 0;
+		}
+		printf("\n");
+	}
+	return ok;
+}
+
+static double totalFrameUs(void) {
+	double total = 0;
+	uint32_t i;
+
+	for (i = 0; i < optGames; i++) {
+		total += (double)results[i].meanFrameUs * results[i].ticks;
+	}
+	return total;
+}
+
+int main(int argc, char **argv) {
+	const char *csvPath = NULL;
+	const char *dumpPath = NULL;
+	result_t *sorted;
+	uint32_t i;
+	uint32_t worst;
+	double elapsed;
+	int same;
+	int opt;
+	uint64_t ticks = 0;
+	uint64_t over30 = 0;
+	uint64_t over60 = 0;
+	uint64_t redrawn = 0;
+	uint64_t skipped = 0;
+	FILE *f;
+
+	while ((opt = getopt(argc, argv, "n:j:s:t:f:bTl:c:d:B")) != -1) {
+		switch (opt) {
+			case 'n': optGames = strtoul(optarg, NULL, 0); break;
+			case 'j': optWorkers = strtoul(optarg, NULL, 0); break;
+			case 's': optSeed = strtoul(optarg, NULL, 0); break;
+			case 't': optTicks = strtoul(optarg, NULL, 0); break;
+			case 'f': optFirePeriod = strtoul(optarg, NULL, 0); break;
+			case 'b': optBot = 1; break;
+			case 'T': optBot = 1; optTest = 1; break;
+			case 'l':
+				f = fopen(optarg, "rb");
+				if (!f) {
+					perror(optarg);
+					return 1;
+				}
+				startSize = fread(startState, 1, sizeof(startState), f);
+				fclose(f);
+				break;
+			case 'c': csvPath = optarg; break;
+			case 'd': dumpPath = optarg; break;
+			case 'B':
+				GLCD_Init();
+				spiCostSprites();
+				return 0;
+			default:
+				fprintf(stderr, "usage: %s [-n games] [-j workers] [-s seed] [-t ticks] [-b] [-f fire period] [-T] [-l snapshot] [-c csv] [-d snapshot] [-B]\n", argv[0]);
+				return 2;
+		}
+	}
+	if (optWorkers == 0) {
+		optWorkers = sysconf(_SC_NPROCESSORS_ONLN);
+	}
+	if (optWorkers > MAX_WORKERS) {
+		optWorkers = MAX_WORKERS;
+	}
+	if (optGames == 0 || optFirePeriod == 0) {
+		fprintf(stderr, "games and fire period must not be 0\n");
+		return 2;
+	}
+	botFirePeriod = optFirePeriod;
+	if (startSize && !loadSnapshot(startState, startSize)) {
+		fprintf(stderr, "invalid start snapshot\n");
+		return 2;
+	}
+
+	// the results and the work ranges are shared between the worker processes
+	results = mmap(NULL, optGames * sizeof(result_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	workers = mmap(NULL, optWorkers * sizeof(worker_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (results == MAP_FAILED || workers == MAP_FAILED) {
+		perror("mmap");
+		return 1;
+	}
+	elapsed = runBatch(optWorkers);
+	if (elapsed < 0) {
+		return 1;
+	}
+
+	printf("%u games, %u workers, seeds %u..%u, max %u ticks, %s input, fire every %u ticks\n",
+	       optGames, optWorkers, optSeed, optSeed + optGames - 1, optTicks, optBot ? "bot" : "scripted", optFirePeriod);
+	printf("%.2f s, %.1f games/s\n\n", elapsed, optGames / elapsed);
+
+	sorted = malloc(optGames * sizeof(result_t));
+	memcpy(sorted, results, optGames * sizeof(result_t));
+	printf("%-16s %8s %8s %8s %8s %8s %10s\n", "", "min", "p50", "p90", "p99", "max", "mean");
+	printDistribution("peak enemies", offsetof(result_t, peakEnemies), sorted);
+	printDistribution("peak bullets", offsetof(result_t, peakBullets), sorted);
+	printDistribution("peak SPI B/frame", offsetof(result_t, peakSpiBytes), sorted);
+	printDistribution("mean SPI B/frame", offsetof(result_t, meanSpiBytes), sorted);
+	printDistribution("peak frame us", offsetof(result_t, peakFrameUs), sorted);
+	printDistribution("mean frame us", offsetof(result_t, meanFrameUs), sorted);
+	printDistribution("kills", offsetof(result_t, kills), sorted);
+	printDistribution("difficulty", offsetof(result_t, difficulty), sorted);
+	printDistribution("ticks", offsetof(result_t, ticks), sorted);
+	printHistogram("peak enemies", offsetof(result_t, peakEnemies));
+	free(sorted);
+
+	for (i = 0; i < optGames; i++) {
+		ticks += results[i].ticks;
+		over30 += results[i].over30Hz;
+		over60 += results[i].over60Hz;
+		redrawn += results[i].redrawn;
+		skipped += results[i].skipped;
+	}
+	printf("\npredicted LCD time, %u cycles per SPI bit at %u MHz\n", spiCost.bitCycles, spiCost.coreClock / 1000000);
+	printf("mean %.0f fps, %.2f%% of frames over the 30 Hz budget, %.2f%% over the 60 Hz budget\n",
+	       ticks ? 1e6 * ticks / (double)totalFrameUs() : 0.0, 100.0 * over30 / ticks, 100.0 * over60 / ticks);
+	printf("%.1f%% of the entity redraws skipped, the entity did not change\n",
+	       redrawn + skipped ? 100.0 * skipped / (redrawn + skipped) : 0.0);
+	if (optBot && !printHitRate() && optTest) {
+		printf("\nself test FAILED\n");
+		return 1;
+	}
+
+	if (csvPath) {
+		f = fopen(csvPath, "w");
+		if (!f) {
+			perror(csvPath);
+			return 1;
+		}
+		fprintf(f, "seed,ticks,kills,difficulty,peak_enemies,peak_bullets,peak_spi_bytes,mean_spi_bytes,peak_frame_us,mean_frame_us\n");
+		for (i = 0; i < optGames; i++) {
+			result_t *r = &results[i];
+			fprintf(f, "%u,%u,%u,%u,%u,%u,%u,%u,%u,%u\n", r->seed, r->ticks, r->kills, r->difficulty,
+			        r->peakEnemies, r->peakBullets, r->peakSpiBytes, r->meanSpiBytes, r->peakFrameUs, r->meanFrameUs);
+		}
+		fclose(f);
+	}
+
+	if (dumpPath) {
+		worst = 0;
+		for (i = 1; i < optWorkers; i++) {
+			if (workers[i].worstEnemies > workers[worst].worstEnemies) {
+				worst = i;
+			}
+		}
+		f = fopen(dumpPath, "wb");
+		if (!f || fwrite(workers[worst].worst, 1, workers[worst].worstSize, f) != workers[worst].worstSize) {
+			perror(dumpPath);
+			return 1;
+		}
+		fclose(f);
+		printf("\nwrote %u byte snapshot with %u live enemies to %s\n",
+		       workers[worst].worstSize, workers[worst].worstEnemies, dumpPath);
+	}
+
+	// last, the one worker runs replace the results and the worst states, the
+	// scripted sweep is played and checked too, its games show state left over
+	// by an earlier game more often than the bot games do
+	if (optTest) {
+		same = checkOneWorker();
+		optBot = 0;
+		if (!same || runBatch(optWorkers) < 0 || !checkOneWorker()) {
+			printf("\nself test FAILED\n");
+			return 1;
+		}
+		printf("\nself test passed\n");
+	}
+	return 0;
+}
@@ -0,0 +1,390 @@
+/*----------------------------------------------------------------------------
+ * Name:    spritegen.c
+ * Purpose: Sprite table generator (Linux)
+ * Note(s): Turns the sprite shapes drawn in sprites.txt into const point
+ *          tables: sprites.h declares one sprite_t per shape, sprites.c
+ *          holds the packed int8 offsets from the sprite centre in flash,
+ *          row after row from the top left, and the index of the first
+ *          point of every row so a renderer can clip whole rows and spans.
+ *          A shape marked "compiled" also gets an unrolled draw routine
+ *          that sends each run of the shape as one GRAM burst. Pixels in a
+ *          longer vertical than horizontal run go down the column with the
+ *          LCD entry mode switched (GLCD_SetVertical), when the cost model
+ *          below says that is cheaper than sending every run along a row.
+ *          Both files are checked in since the Keil build does not run
+ *          host tools, run the generator again after changing a shape.
+ *
+ *          Build and run from the project directory:
+ *            gcc -O2 -Wall -Wextra -o spritegen host/spritegen.c
+ *            ./spritegen sprites.txt
+ *
+ *          See sprites.txt for the shape format.
+ *----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+
+#define MAX_SPRITES 16
+#define MAX_POINTS  255
+#define MAX_NAME    32
+#define MAX_LINE    256
+
+// SPI bytes of a GRAM run: the cursor (two register writes), the GRAM
+// command and the data start byte, then two bytes per pixel, and of
+// switching the entry mode to columns and back (two register writes)
+#define RUN_BYTES    (2*6 + 3 + 1)
+#define PIXEL_BYTES  2
+#define SWITCH_BYTES (2*6)
+
+typedef struct {
+	char name[MAX_NAME];
+	int x[MAX_POINTS];
+	int y[MAX_POINTS];
+	int count;
+	int radius;
+	int top;
+	int rows;
+	int hasCentre;
+	int centreX;
+	int centreY;
+	int compiled;
+} shape_t;
+
+static shape_t shapes[MAX_SPRITES];
+static int shapeCount = 0;
+
+/*----------------------------------------------------------------------------
+  Read the shapes, the pixels are first stored relative to the top left
+  corner and moved to the centre once the whole shape has been read
+ *----------------------------------------------------------------------------*/
+static int finishShape(const char *path, shape_t *s) {
+	int i;
+
+	if (!s->hasCentre) {
+		fprintf(stderr, "%s: sprite %s has no centre\n", path, s->name);
+		return 0;
+	}
+	for (i = 0; i < s->count; i++) {
+		s->x[i] -= s->centreX;
+		s->y[i] -= s->centreY;
+		if (i == 0) {
+			s->top = s->y[i];
+		}
+		s->rows = s->y[i] - s->top + 1;
+		if (abs(s->x[i]) > s->radius) {
+			s->radius = abs(s->x[i]);
+		}
+		if (abs(s->y[i]) > s->radius) {
+			s->radius = abs(s->y[i]);
+		}
+		if (s->x[i] < -128 || s->x[i] > 127 || s->y[i] < -128 || s->y[i] > 127) {
+			fprintf(stderr, "%s: sprite %s does not fit int8 offsets\n", path, s->name);
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static int readShapes(const char *path) {
+	char line[MAX_LINE];
+	shape_t *s = NULL;
+	int row = 0, x, len;
+	FILE *f = fopen(path, "r");
+
+	if (!f) {
+		perror(path);
+		return 0;
+	}
+	while (fgets(line, sizeof(line), f)) {
+		len = strcspn(line, "\r\n");
+		line[len] = 0;
+		if (line[0] == '#' && s == NULL) {
+			continue;
+		}
+		if (strncmp(line, "sprite ", 7) == 0) {
+			if (shapeCount == MAX_SPRITES) {
+				fprintf(stderr, "%s: more than %d sprites\n", path, MAX_SPRITES);
+				fclose(f);
+				return 0;
+			}
+			s = &shapes[shapeCount++];
+			memset(s, 0, sizeof(*s));
+			if (sscanf(line + 7, "%31s compiled%n", s->name, &x) == 1 && x == len - 7) {
+				s->compiled = 1;
+			}
+			row = 0;
+			continue;
+		}
+		if (len == 0) {
+			if (s && !finishShape(path, s)) {
+				fclose(f);
+				return 0;
+			}
+			s = NULL;
+			continue;
+		}
+		if (s == NULL) {
+			fprintf(stderr, "%s: pixels outside of a sprite: %s\n", path, line);
+			fclose(f);
+			return 0;
+		}
+		for (x = 0; x < len; x++) {
+			if (line[x] == '@' || line[x] == '+') {
+				s->hasCentre = 1;
+				s->centreX = x;
+				s->centreY = row;
+			}
+			if (line[x] == '#' || line[x] == '@') {
+				if (s->count == MAX_POINTS) {
+					fprintf(stderr, "%s: sprite %s has more than %d pixels\n", path, s->name, MAX_POINTS);
+					fclose(f);
+					return 0;
+				}
+				s->x[s->count] = x;
+				s->y[s->count] = row;
+				s->count++;
+			}
+		}
+		row++;
+	}
+	fclose(f);
+	return s == NULL || finishShape(path, s);
+}
+
+/*----------------------------------------------------------------------------
+  Write the tables, the project sources use DOS line endings
+ *----------------------------------------------------------------------------*/
+static void writeLine(FILE *f, const char *fmt, ...) {
+	va_list ap;
+
+	va_start(ap, fmt);
+	vfprintf(f, fmt, ap);
+	va_end(ap);
+	fputs("\r\n", f);
+}
+
+static int writeHeader(const char *path) {
+	int i, max = 0;
+	FILE *f = fopen(path, "wb");
+
+	if (!f) {
+		perror(path);
+		return 0;
+	}
+	for (i = 0; i < shapeCount; i++) {
+		if (shapes[i].count > max) {
+			max = shapes[i].count;
+		}
+	}
+	writeLine(f, "// generated by host/spritegen.c from sprites.txt, do not edit");
+	writeLine(f, "#ifndef _SPRITES_H");
+	writeLine(f, "#define _SPRITES_H");
+	writeLine(f, "");
+	writeLine(f, "#include <stdint.h>");
+	writeLine(f, "");
+	writeLine(f, "// offset of a sprite pixel from the sprite centre");
+	writeLine(f, "typedef struct {");
+	writeLine(f, "\tint8_t x;");
+	writeLine(f, "\tint8_t y;");
+	writeLine(f, "} spritepoint_t;");
+	writeLine(f, "");
+	writeLine(f, "// the pixels of a sprite row after row from the top left, none is further than");
+	writeLine(f, "// radius from the centre in x or y, the points of row r (y = top + r) are");
+	writeLine(f, "// points[rowStart[r]] up to but not including points[rowStart[r + 1]]");
+	writeLine(f, "typedef struct {");
+	writeLine(f, "\tconst spritepoint_t *points;");
+	writeLine(f, "\tconst uint8_t *rowStart;");
+	writeLine(f, "\tuint8_t count;");
+	writeLine(f, "\tuint8_t radius;");
+	writeLine(f, "\tint8_t top;");
+	writeLine(f, "\tuint8_t rows;");
+	writeLine(f, "} sprite_t;");
+	writeLine(f, "");
+	writeLine(f, "// most pixels of any sprite");
+	writeLine(f, "#define SPRITE_MAX_POINTS %d", max);
+	writeLine(f, "");
+	for (i = 0; i < shapeCount; i++) {
+		writeLine(f, "extern const sprite_t %sSprite;", shapes[i].name);
+	}
+	writeLine(f, "");
+	writeLine(f, "// draw a compiled sprite centered at (x, y) in one color, the whole sprite has to");
+	writeLine(f, "// be on the screen and the draw window has to be the whole screen");
+	for (i = 0; i < shapeCount; i++) {
+		if (shapes[i].compiled) {
+			writeLine(f, "void %sSpriteDraw(int x, int y, unsigned short color);", shapes[i].name);
+		}
+	}
+	writeLine(f, "");
+	writeLine(f, "#endif /* _SPRITES_H */");
+	fclose(f);
+	return 1;
+}
+
+static const char *offset(char *buf, const char *var, int d) {
+	if (d == 0) {
+		sprintf(buf, "%s", var);
+	}
+	else {
+		sprintf(buf, "%s %c %d", var, d < 0 ? '-' : '+', abs(d));
+	}
+	return buf;
+}
+
+static int findPoint(const shape_t *s, int x, int y) {
+	int i;
+
+	for (i = 0; i < s->count; i++) {
+		if (s->x[i] == x && s->y[i] == y) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+static int runLength(const shape_t *s, int i, int dx, int dy) {
+	// length of the run through point i along (dx, dy)
+	int n = 1, k;
+
+	for (k = 1; findPoint(s, s->x[i] - k*dx, s->y[i] - k*dy) >= 0; k++, n++);
+	for (k = 1; findPoint(s, s->x[i] + k*dx, s->y[i] + k*dy) >= 0; k++, n++);
+	return n;
+}
+
+static void writeRun(FILE *f, const shape_t *s, int i, int n) {
+	char bx[16], by[16];
+
+	writeLine(f, "	GLCD_SetCursor(%s, %s);", offset(bx, "x", s->x[i]), offset(by, "y", s->y[i]));
+	writeLine(f, "	GLCD_WrCmd(0x22);");
+	writeLine(f, "	GLCD_WrDatStart();");
+	while (n--) {
+		writeLine(f, "	GLCD_WrDatOnly(color);");
+	}
+	writeLine(f, "	GLCD_WrDatStop();");
+}
+
+static void writeRoutine(FILE *f, const shape_t *s) {
+	// the points are stored row after row from the left, so a row run is a
+	// sequence of points in the same row with neighbouring x. A point that
+	// lies in a longer column than row goes into a column run instead
+	int vertical[MAX_POINTS];
+	int i, j, k, rowOnly = 0, rows = 0, columns = 0, bytes;
+
+	for (i = 0; i < s->count; i++) {
+		if (i == 0 || s->y[i] != s->y[i - 1] || s->x[i] != s->x[i - 1] + 1) {
+			rowOnly++;
+		}
+		vertical[i] = runLength(s, i, 0, 1) > runLength(s, i, 1, 0);
+	}
+	for (i = 0; i < s->count; i++) {
+		if (!vertical[i] && (i == 0 || vertical[i - 1] || s->y[i] != s->y[i - 1] || s->x[i] != s->x[i - 1] + 1)) {
+			rows++;
+		}
+		k = findPoint(s, s->x[i], s->y[i] - 1);
+		if (vertical[i] && (k < 0 || !vertical[k])) {
+			columns++;
+		}
+	}
+	bytes = (rows + columns) * RUN_BYTES + s->count * PIXEL_BYTES + SWITCH_BYTES;
+	if (columns == 0 || bytes >= rowOnly * RUN_BYTES + s->count * PIXEL_BYTES) {
+		for (i = 0; i < s->count; i++) {
+			vertical[i] = 0;
+		}
+		rows = rowOnly;
+		columns = 0;
+		bytes = rowOnly * RUN_BYTES + s->count * PIXEL_BYTES;
+	}
+
+	writeLine(f, "");
+	writeLine(f, "void %sSpriteDraw(int x, int y, unsigned short color){", s->name);
+	writeLine(f, "	// %d pixels in %d row runs and %d column runs, %d SPI bytes (%d along the rows only)",
+	          s->count, rows, columns, bytes, rowOnly * RUN_BYTES + s->count * PIXEL_BYTES);
+	for (i = 0; i < s->count; i = j) {
+		if (vertical[i]) {
+			j = i + 1;
+			continue;
+		}
+		for (j = i + 1; j < s->count && !vertical[j] && s->y[j] == s->y[j - 1] && s->x[j] == s->x[j - 1] + 1; j++);
+		writeRun(f, s, i, j - i);
+	}
+	if (columns == 0) {
+		writeLine(f, "}");
+		return;
+	}
+	writeLine(f, "	GLCD_SetVertical(1);");
+	for (i = 0; i < s->count; i++) {
+		k = findPoint(s, s->x[i], s->y[i] - 1);
+		if (!vertical[i] || (k >= 0 && vertical[k])) {
+			continue;
+		}
+		for (j = 1; (k = findPoint(s, s->x[i], s->y[i] + j)) >= 0 && vertical[k]; j++);
+		writeRun(f, s, i, j);
+	}
+	writeLine(f, "	GLCD_SetVertical(0);");
+	writeLine(f, "}");
+}
+
+static void writeRows(FILE *f, const shape_t *s) {
+	char buf[MAX_LINE];
+	int r, i = 0;
+
+	writeLine(f, "static const uint8_t %sRows[%d] = {", s->name, s->rows + 1);
+	buf[0] = 0;
+	for (r = 0; r <= s->rows; r++) {
+		while (i < s->count && s->y[i] < s->top + r) {
+			i++;
+		}
+		snprintf(buf + strlen(buf), sizeof(buf) - strlen(buf), "%s%3d%s", r % 16 ? " " : "\t", i, r < s->rows ? "," : "");
+		if (r % 16 == 15 || r == s->rows) {
+			writeLine(f, "%s", buf);
+			buf[0] = 0;
+		}
+	}
+	writeLine(f, "};");
+}
+
+static int writeSource(const char *path) {
+	char buf[MAX_LINE];
+	int i, j, n;
+	FILE *f = fopen(path, "wb");
+
+	if (!f) {
+		perror(path);
+		return 0;
+	}
+	writeLine(f, "// generated by host/spritegen.c from sprites.txt, do not edit");
+	writeLine(f, "#include \"GLCD.h\"");
+	writeLine(f, "#include \"sprites.h\"");
+	for (i = 0; i < shapeCount; i++) {
+		writeLine(f, "");
+		writeLine(f, "static const spritepoint_t %sPoints[%d] = {", shapes[i].name, shapes[i].count);
+		for (j = 0; j < shapes[i].count; j += 8) {
+			buf[0] = 0;
+			for (n = j; n < shapes[i].count && n < j + 8; n++) {
+				snprintf(buf + strlen(buf), sizeof(buf) - strlen(buf), "%s{ %3d, %3d }%s",
+				         n == j ? "\t" : " ", shapes[i].x[n], shapes[i].y[n], n + 1 < shapes[i].count ? "," : "");
+			}
+			writeLine(f, "%s", buf);
+		}
+		writeLine(f, "};");
+		writeRows(f, &shapes[i]);
+		writeLine(f, "const sprite_t %sSprite = { %sPoints, %sRows, %d, %d, %d, %d };", shapes[i].name, shapes[i].name,
+		          shapes[i].name, shapes[i].count, shapes[i].radius, shapes[i].top, shapes[i].rows);
+		if (shapes[i].compiled) {
+			writeRoutine(f, &shapes[i]);
+		}
+	}
+	fclose(f);
+	return 1;
+}
+
+int main(int argc, char **argv) {
+	if (argc != 2) {
+		fprintf(stderr, "usage: spritegen sprites.txt\n");
+		return 2;
+	}
+	if (!readShapes(argv[1]) || !writeHeader("sprites.h") || !writeSource("sprites.c")) {
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,74 @@
+#include <stdio.h>
+#include <string.h>
+#include "GLCD.h"
+#include "game.h"
+#include "hud.h"
+
+//font 0 of GLCD_DisplayChar
+#define HUD_FONT    0
+#define CHAR_W      6
+#define CHAR_H      8
+#define HUD_COLS    (WIDTH/CHAR_W)
+#define HUD_TOP     (HUD_LINE*CHAR_H)
+
+//the characters on the screen, 0 where the HUD has to draw again
+static char shown[HUD_COLS + 1];
+//set when something has to be drawn by the next hudUpdate
+static int touched = 1;
+//the values of the last update
+static int shownKills, shownLives, shownLevel, shownFps;
+
+static int clamp(int value, int max){
+	return value < 0 ? 0 : value > max ? max : value;
+}
+
+void hudReset(void){
+	memset(shown, 0, sizeof(shown));
+	touched = 1;
+}
+
+void hudTouch(point_t at, int radius){
+	int col, last;
+
+	if (at.y + radius < HUD_TOP || at.y - radius >= HUD_TOP + CHAR_H) {
+		return;
+	}
+	col = clamp(at.x - radius, WIDTH - 1) / CHAR_W;
+	last = clamp(at.x + radius, WIDTH - 1) / CHAR_W;
+	for (; col <= last; col++) {
+		shown[col] = 0;
+	}
+	touched = 1;
+}
+
+void hudUpdate(int fps){
+	char line[HUD_COLS + 1];
+	int col;
+	int drawn = 0;
+
+	if (!touched && kills == shownKills && lives == shownLives && difficulty == shownLevel && fps == shownFps) {
+		return;
+	}
+	shownKills = kills;
+	shownLives = lives;
+	shownLevel = difficulty;
+	shownFps = fps;
+	touched = 0;
+
+	//fixed fields with the numbers to the left, so a digit only changes when its value does
+	sprintf(line, "SCORE %-5d LIVES %d LEVEL %-2d FPS %-3d",
+	        clamp(kills, 99999), clamp(lives, 9), clamp(difficulty, 99), clamp(fps, 999));
+	GLCD_SetBackColor(Black);
+	GLCD_SetTextColor(White);
+	for (col = 0; line[col] != 0; col++) {
+		if (shown[col] != line[col]) {
+			GLCD_DisplayChar(HUD_LINE, col, HUD_FONT, line[col]);
+			shown[col] = line[col];
+			drawn = 1;
+		}
+	}
+	//the compiled sprites and the pixel cursor want the whole screen as the draw window
+	if (drawn) {
+		GLCD_WindowMax();
+	}
+}
@@ -0,0 +1,22 @@
+#ifndef _HUD_H
+#define _HUD_H
+
+#include "game.h"
+
+// the HUD is the bottom text line of the game screen in the 6x8 font: score,
+// lives, difficulty level and frame rate, drawn over the sprites
+#define HUD_LINE    (HEIGHT/8 - 1)
+
+// forget what is on the screen, the next hudUpdate draws the whole line, call
+// after clearing the game screen
+void hudReset(void);
+
+// a sprite of the given radius was drawn or erased at the point, the HUD
+// characters under it are drawn again by the next hudUpdate
+void hudTouch(point_t at, int radius);
+
+// draw the characters that changed or were drawn over since the last update,
+// nothing is sent to the LCD when neither happened
+void hudUpdate(int fps);
+
+#endif /* _HUD_H */
@@ -1,3 +1,6 @@
+#ifndef _QUEUE_H
+#define _QUEUE_H
+
 typedef struct node {
     int val;
     struct node *next;
@@ -7,3 +10,4 @@ void enqueue(node_t **head, int val);
 int dequeue(node_t **head);
 void print_list(node_t *head);
 
+#endif /* _QUEUE_H */
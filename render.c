@@ -0,0 +1,517 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "GLCD.h"
+#include "game.h"
+#include "render.h"
+#include "sprites.h"
+#include "hud.h"
+#include "target.h"
+
+renderstats_t renderStats = { 0, 0 };
+
+//pixels of a sprite before and after a move, in screen coordinates
+static point_t fromPixels[SPRITE_MAX_POINTS];
+static point_t toPixels[SPRITE_MAX_POINTS];
+
+//the shadow only applies to the direct drawing path
+#define SHADOW (RENDER_SHADOW && !RENDER_TILED)
+//the compiled sprites only draw whole sprites, so not together with the shadow
+#define COMPILED (RENDER_COMPILED && !RENDER_TILED && !SHADOW)
+
+//only the tiled path can skip unchanged entities: drawing directly, the erase of
+//another sprite can black out pixels of an entity that did not move
+#define SKIP_CLEAN RENDER_TILED
+
+//a sprite bounding box is off the screen, crosses a screen edge or lies on the screen
+#define CLIP_OUTSIDE 0
+#define CLIP_PARTIAL 1
+#define CLIP_INSIDE  2
+
+#if RENDER_TILED
+#define TILE_COLS (WIDTH / RENDER_TILE)
+#define TILE_ROWS (HEIGHT / RENDER_TILE)
+
+//one bit per tile that has to be sent to the LCD at the end of the frame
+static uint32_t dirtyTiles[TILE_ROWS][(TILE_COLS + 31) / 32];
+//the run of tiles being composed, row after row
+static unsigned short tileBuffer[RENDER_TILE * RENDER_TILE * RENDER_RUN];
+static int tileSpan;
+//screen pixels of the player drawn this frame
+static point_t playerPixels[SPRITE_MAX_POINTS];
+static int playerPixelCount = 0;
+
+static void markPixel(int x, int y){
+	// mark the tile that holds a screen pixel as dirty, the pixel has to be on the screen
+	x /= RENDER_TILE;
+	dirtyTiles[y / RENDER_TILE][x >> 5] |= 1u << (x & 31);
+}
+
+static void plotTile(int x, int y, int tx, int ty, unsigned short color){
+	// draw a screen pixel if it falls into the tiles at (tx, ty)
+	x -= tx;
+	y -= ty;
+	if (x >= 0 && y >= 0 && x < tileSpan && y < RENDER_TILE) {
+		tileBuffer[y * tileSpan + x] = color;
+	}
+}
+
+static void plotSprite(const sprite_t *sprite, point_t at, int tx, int ty, unsigned short color){
+	// draw the part of a sprite centered at (at.x, at.y) that falls into the tiles at (tx, ty)
+	int i;
+	int radius = sprite->radius;
+	if (at.x + radius < tx || at.x - radius >= tx + tileSpan || at.y + radius < ty || at.y - radius >= ty + RENDER_TILE) {
+		return;
+	}
+	for (i = 0; i < sprite->count; i++) {
+		plotTile(sprite->points[i].x + at.x, sprite->points[i].y + at.y, tx, ty, color);
+	}
+}
+
+static void composeTiles(int tx, int ty, int n){
+	// build n tiles side by side from the background up: enemies, bullets and the player on top
+	int i;
+	tileSpan = n * RENDER_TILE;
+	for (i = 0; i < tileSpan * RENDER_TILE; i++) {
+		tileBuffer[i] = Black;
+	}
+	for (i = 0; i < enemyCount; i++) {
+		if (enemies[i].point.x != DEADPOINTLOC || enemies[i].point.y != DEADPOINTLOC) {
+			plotSprite(&enemySprite, enemies[i].point, tx, ty, Red);
+		}
+	}
+	for (i = 0; i < bulletCount; i++) {
+		if (bullets[i].point.x != DEADPOINTLOC || bullets[i].point.y != DEADPOINTLOC) {
+			plotSprite(&bulletSprite, bullets[i].point, tx, ty, Magenta);
+		}
+	}
+	//the player pixels are already in screen coordinates
+	for (i = 0; i < playerPixelCount; i++) {
+		plotTile(playerPixels[i].x, playerPixels[i].y, tx, ty, Green);
+	}
+	GLCD_WriteWindow(tx, ty, tileSpan, RENDER_TILE, tileBuffer);
+}
+
+void composeFrame(void){
+	// send every dirty tile once and clear the dirty map for the next frame,
+	// neighbouring dirty tiles of a row share one window burst
+	int row;
+	int col;
+	int n;
+	for (row = 0; row < TILE_ROWS; row++) {
+		for (col = 0; col < TILE_COLS; col += n) {
+			n = 0;
+			while (col + n < TILE_COLS && n < RENDER_RUN && (dirtyTiles[row][(col + n) >> 5] & (1u << ((col + n) & 31)))) {
+				n++;
+			}
+			if (n) {
+				composeTiles(col * RENDER_TILE, row * RENDER_TILE, n);
+			}
+			else {
+				n = 1;
+			}
+		}
+		for (col = 0; col < (TILE_COLS + 31) / 32; col++) {
+			dirtyTiles[row][col] = 0;
+		}
+	}
+}
+#endif
+
+#if SHADOW
+//edge of the square around a sprite centre covered by a sprite mask
+#define MASK_SIZE 32
+
+//two bits per panel pixel: the sprite color it shows, 0 for black, 19.2 KB in the
+//AHB SRAM next to the glyph cache, the CPU local SRAM has no room left for it
+static uint32_t litPixels[HEIGHT][WIDTH / 16] AHBSRAM;
+//sprite pixels before and after a move, one bit per pixel around the sprite centre
+static uint32_t fromMask[MASK_SIZE];
+static uint32_t toMask[MASK_SIZE];
+
+static int shadeOf(unsigned short color){
+	// the shadow code of a sprite color
+	switch (color) {
+	case Red:
+		return 1;
+	case Magenta:
+		return 2;
+	case Green:
+		return 3;
+	default:
+		return 0;
+	}
+}
+
+static int shadeAt(int x, int y){
+	return (litPixels[y][x >> 4] >> ((x & 15) * 2)) & 3;
+}
+
+static void buildMask(uint32_t *mask, const point_t *pixels, int count, point_t centre){
+	// set the mask bit of every pixel that lies within MASK_SIZE/2 of the centre
+	int i;
+	int x;
+	int y;
+	memset(mask, 0, MASK_SIZE * sizeof(uint32_t));
+	for (i = 0; i < count; i++) {
+		x = pixels[i].x - centre.x + MASK_SIZE/2;
+		y = pixels[i].y - centre.y + MASK_SIZE/2;
+		if (x >= 0 && y >= 0 && x < MASK_SIZE && y < MASK_SIZE) {
+			mask[y] |= 1u << x;
+		}
+	}
+}
+
+static int inMask(const uint32_t *mask, point_t pixel, point_t centre){
+	int x = pixel.x - centre.x + MASK_SIZE/2;
+	int y = pixel.y - centre.y + MASK_SIZE/2;
+	if (x < 0 || y < 0 || x >= MASK_SIZE || y >= MASK_SIZE) {
+		return 0;
+	}
+	return (mask[y] >> x) & 1;
+}
+#endif
+
+#if !RENDER_TILED
+static void plotPixel(int x, int y, unsigned short color){
+	// draw a single pixel, the pixel has to be on the screen
+#if SHADOW
+	//black only has to go to lit pixels, everything else lights the pixel in its color
+	int shade = shadeOf(color);
+	if (shade == 0 && shadeAt(x, y) == 0) {
+		return;
+	}
+	litPixels[y][x >> 4] = (litPixels[y][x >> 4] & ~(3u << ((x & 15) * 2))) | (uint32_t)shade << ((x & 15) * 2);
+#endif
+	GLCD_SetTextColor(color);
+	GLCD_PutPixel(x, y);
+}
+#endif
+
+static int clipBox(point_t at, int radius){
+	// classify the square of radius around a sprite centre against the screen
+	if (at.x + radius < 0 || at.y + radius < 0 || at.x - radius >= WIDTH || at.y - radius >= HEIGHT) {
+		return CLIP_OUTSIDE;
+	}
+	if (at.x - radius >= 0 && at.y - radius >= 0 && at.x + radius < WIDTH && at.y + radius < HEIGHT) {
+		return CLIP_INSIDE;
+	}
+	return CLIP_PARTIAL;
+}
+
+static int placeSprite(point_t *pixels, const sprite_t *sprite, point_t at){
+	// shift the sprite points to the screen position of the sprite and return the number
+	// of pixels on the screen, a clipped sprite skips the rows above and below the
+	// screen and cuts the other rows down to the span between the screen edges
+	int i;
+	int end;
+	int row;
+	int lastRow;
+	int count = 0;
+	int clip = clipBox(at, sprite->radius);
+	if (clip == CLIP_OUTSIDE) {
+		return 0;
+	}
+	if (clip == CLIP_INSIDE) {
+		for (i = 0; i < sprite->count; i++) {
+			pixels[i].x = sprite->points[i].x + at.x;
+			pixels[i].y = sprite->points[i].y + at.y;
+		}
+		return sprite->count;
+	}
+	row = -at.y - sprite->top;
+	if (row < 0) {
+		row = 0;
+	}
+	lastRow = HEIGHT - 1 - at.y - sprite->top;
+	if (lastRow >= sprite->rows) {
+		lastRow = sprite->rows - 1;
+	}
+	for (; row <= lastRow; row++) {
+		//the points of a row go from left to right
+		i = sprite->rowStart[row];
+		end = sprite->rowStart[row + 1];
+		while (i < end && sprite->points[i].x + at.x < 0) {
+			i++;
+		}
+		while (end > i && sprite->points[end - 1].x + at.x >= WIDTH) {
+			end--;
+		}
+		for (; i < end; i++) {
+			pixels[count].x = sprite->points[i].x + at.x;
+			pixels[count].y = sprite->points[i].y + at.y;
+			count++;
+		}
+	}
+	return count;
+}
+
+static int rotatePlayer(point_t *pixels, angle_t angle){
+	// rotate the player points about the player position and return the number of
+	// pixels on the screen
+	int i;
+	int count = 0;
+	int clip;
+	int32_t size = 10;
+	int32_t x0 = WIDTH/2;
+	int32_t y0 = size;
+	int32_t x;
+	int32_t y;
+	int32_t c = cosQ15(angle);
+	int32_t s = sinQ15(angle);
+	point_t centre;
+	//a rotated point stays within radius*sqrt(2) of the centre, plus one for rounding down
+	centre.x = x0;
+	centre.y = y0;
+	clip = clipBox(centre, playerSprite.radius * 3 / 2 + 1);
+	if (clip == CLIP_OUTSIDE) {
+		return 0;
+	}
+	for(i = 0; i < playerSprite.count; i++){
+		//for each point of the player sprite, rotate the point about its zero value based on the angle
+		x = playerSprite.points[i].x;
+		y = playerSprite.points[i].y;
+		//Rotated points, rounded down to the pixel
+		pixels[count].x = ((x*c - y*s) >> 15) + x0;
+		pixels[count].y = ((y*c + x*s) >> 15) + y0;
+		//the rotated rows are no spans any more, so a clipped player checks every pixel
+		if (clip == CLIP_INSIDE || (pixels[count].x >= 0 && pixels[count].y >= 0 && pixels[count].x < WIDTH && pixels[count].y < HEIGHT)) {
+			count++;
+		}
+	}
+	return count;
+}
+
+#if SHADOW
+static void movePixels(int fromCount, point_t fromCentre, int toCount, point_t toCentre, unsigned short color){
+	// move a sprite from fromPixels to toPixels: only the old pixels that the new
+	// position does not cover are erased, and only the new pixels that the old
+	// position did not light, or that another sprite erased or drew over since, are drawn
+	int i;
+	int shade = shadeOf(color);
+	buildMask(fromMask, fromPixels, fromCount, fromCentre);
+	buildMask(toMask, toPixels, toCount, toCentre);
+	for (i = 0; i < fromCount; i++) {
+		if (!inMask(toMask, fromPixels[i], toCentre)) {
+			plotPixel(fromPixels[i].x, fromPixels[i].y, Black);
+		}
+	}
+	for (i = 0; i < toCount; i++) {
+		if (!inMask(fromMask, toPixels[i], fromCentre) || shadeAt(toPixels[i].x, toPixels[i].y) != shade) {
+			plotPixel(toPixels[i].x, toPixels[i].y, color);
+		}
+	}
+}
+#endif
+
+static void drawSprite(const sprite_t *sprite, point_t point, unsigned short color){
+	// draw the on-screen pixels of a sprite, with RENDER_TILED only mark their tiles
+	int i;
+	int count = placeSprite(toPixels, sprite, point);
+#if RENDER_TILED
+	//composeFrame takes the colors from the game state
+	(void)color;
+#endif
+	for(i = 0; i < count; i++){
+#if RENDER_TILED
+		markPixel(toPixels[i].x, toPixels[i].y);
+#else
+		plotPixel(toPixels[i].x, toPixels[i].y, color);
+#endif
+	}
+}
+
+void drawEnemy(point_t point, int draw){
+	// function for drawing a single enemy
+	// accepts a point and whether to draw or not
+	// if draw is 1, it draws in red, if draw is 0, it draws in black, therefore erasing it
+	hudTouch(point, enemySprite.radius);
+#if COMPILED
+	if (clipBox(point, enemySprite.radius) == CLIP_INSIDE) {
+		enemySpriteDraw(point.x, point.y, draw == 1 ? Red : Black);
+		return;
+	}
+#endif
+	drawSprite(&enemySprite, point, draw == 1 ? Red : Black);
+}
+
+void drawBullet(point_t point, int draw){
+	//function for drawing a single bullet
+	// if draw is 1, it draws in magenta, if draw is 0, it draws in black, therefore erasing it
+	hudTouch(point, bulletSprite.radius);
+#if COMPILED
+	if (clipBox(point, bulletSprite.radius) == CLIP_INSIDE) {
+		bulletSpriteDraw(point.x, point.y, draw == 1 ? Magenta : Black);
+		return;
+	}
+#endif
+	drawSprite(&bulletSprite, point, draw == 1 ? Magenta : Black);
+}
+
+void drawPlayer(int draw){
+	// draw player function that takes in whether to draw or not
+	int i;
+	int count;
+	//if draw is 1, it will draw at the player angle
+	//if draw is 0, it will erase at the previous angle
+	angle_t angle = draw == 1 ? player_angle : prev_player_angle;
+	point_t *pixels = draw == 1 ? toPixels : fromPixels;
+#if RENDER_TILED
+	//the drawn pixels are kept for composeFrame
+	if (draw == 1) {
+		pixels = playerPixels;
+	}
+#endif
+	count = rotatePlayer(pixels, angle);
+	for(i = 0; i < count; i++){
+#if RENDER_TILED
+		markPixel(pixels[i].x, pixels[i].y);
+#else
+		plotPixel(pixels[i].x, pixels[i].y, draw == 1 ? Green : Black);
+#endif
+	}
+	//set the previous player angle to be the player angle if it is drawn in the ne location
+	if (draw == 1){
+#if RENDER_TILED
+		playerPixelCount = count;
+#endif
+		prev_player_angle = angle;
+	}
+}
+
+static void redrawPlayer(void){
+	// erase the player at the previous angle and draw it at the player angle
+#if SHADOW
+	point_t centre;
+	int fromCount;
+	int toCount;
+	centre.x = WIDTH/2;
+	centre.y = 10;
+	fromCount = rotatePlayer(fromPixels, prev_player_angle);
+	toCount = rotatePlayer(toPixels, player_angle);
+	movePixels(fromCount, centre, toCount, centre, Green);
+	prev_player_angle = player_angle;
+#else
+	drawPlayer(0);
+	drawPlayer(1);
+#endif
+}
+
+static void redrawEnemy(point_t from, point_t to){
+	// erase an enemy at its previous position and draw it at the new one
+#if SHADOW
+	int fromCount = placeSprite(fromPixels, &enemySprite, from);
+	int toCount = placeSprite(toPixels, &enemySprite, to);
+	hudTouch(from, enemySprite.radius);
+	hudTouch(to, enemySprite.radius);
+	movePixels(fromCount, from, toCount, to, Red);
+#else
+	drawEnemy(from, 0);
+	drawEnemy(to, 1);
+#endif
+}
+
+static void redrawBullet(point_t from, point_t to){
+	// erase a bullet at its previous position and draw it at the new one
+#if SHADOW
+	int fromCount = placeSprite(fromPixels, &bulletSprite, from);
+	int toCount = placeSprite(toPixels, &bulletSprite, to);
+	hudTouch(from, bulletSprite.radius);
+	hudTouch(to, bulletSprite.radius);
+	movePixels(fromCount, from, toCount, to, Magenta);
+#else
+	drawBullet(from, 0);
+	drawBullet(to, 1);
+#endif
+}
+
+void renderFrame(void){
+	// function to draw one frame, the collision detection is done as the entities are drawn
+	int i;
+	int deletedEnemy = 0;
+
+	//erase the previous player location and draw the player in the new location, if it moved
+	if (playerDirty || !SKIP_CLEAN) {
+		redrawPlayer();
+		playerDirty = 0;
+		renderStats.redrawn++;
+	} else {
+		renderStats.skipped++;
+	}
+	
+	for (i = 0; i < bulletCount; i++) {
+		//if the bullet is dead, skip this iteration of the for loop
+		if (bullets[i].point.x == DEADPOINTLOC && bullets[i].point.y == DEADPOINTLOC) {
+			continue;
+		}
+		//check if the bullet killed an enemy
+		deletedEnemy = checkBulletCollision(i);
+		
+		if (deletedEnemy == -1) {
+			//move the bullet if it didn't collide with an enemy and changed its position
+			if (bullets[i].dirty || !SKIP_CLEAN) {
+				redrawBullet(bullets[i].prevPoint, bullets[i].point);
+				bullets[i].dirty = 0;
+				renderStats.redrawn++;
+			} else {
+				renderStats.skipped++;
+			}
+		} else {
+			//erase the bullet and the enemy that was killed
+			drawBullet(bullets[i].prevPoint, 0);
+			drawEnemy(enemies[deletedEnemy].prevPoint, 0);
+		}
+	}
+	for (i = 0; i < enemyCount; i++) {
+		//if the enemy is dead, skip this iteration of the for loop
+		if (enemies[i].point.x == DEADPOINTLOC && enemies[i].point.y == DEADPOINTLOC) {
+			continue;
+		}
+		//check if the enemy collided with the player, if not, move the enemy to its new position
+		if (checkPlayerCollision(i) != 1) {
+			if (enemies[i].dirty || !SKIP_CLEAN) {
+				redrawEnemy(enemies[i].prevPoint, enemies[i].point);
+				enemies[i].dirty = 0;
+				renderStats.redrawn++;
+			} else {
+				renderStats.skipped++;
+			}
+		} else {
+			//erase the enemy that hit the player
+			drawEnemy(enemies[i].prevPoint, 0);
+		}
+	}
+#if RENDER_TILED
+	//every changed tile goes to the LCD once, with all sprites layered in it
+	composeFrame();
+#endif
+}
+
+static void drawGameOver(void){
+	// done function of the game over clear, the text goes on the black screen
+	char finalScore[20];
+	sprintf(finalScore, "Score: %d", kills);
+	GLCD_SetBackColor(Black);
+	GLCD_SetTextColor(White);
+	GLCD_DisplayString(3, 5, 1, (unsigned char *)"Game Over");
+	GLCD_DisplayString(4, 5, 1, (unsigned char *)finalScore);
+	GLCD_DisplayString(6, 5, 1, (unsigned char *)"Press Button");
+}
+
+void renderReset(void){
+	// forget what is on the screen, the next frame starts from a black screen
+#if RENDER_TILED
+	memset(dirtyTiles, 0, sizeof(dirtyTiles));
+	playerPixelCount = 0;
+#endif
+#if SHADOW
+	memset(litPixels, 0, sizeof(litPixels));
+#endif
+}
+
+void renderGameOver(void){
+	// function to start the game over screen, the clear is sent by GLCD_ClearStep
+	GLCD_ClearStart(Black, drawGameOver);
+	//the text is not tracked, the game screen starts over from black
+	renderReset();
+}
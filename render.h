@@ -0,0 +1,66 @@
+#ifndef _RENDER_H
+#define _RENDER_H
+
+#include "game.h"
+
+// set to 1 to compose the changed screen tiles in RAM and send each of them to
+// the LCD in one burst, 0 draws every sprite pixel straight to the LCD
+#ifndef RENDER_TILED
+    #define RENDER_TILED 1
+#endif
+
+// tile edge in pixels, a power of two that divides WIDTH and HEIGHT
+#ifndef RENDER_TILE
+    #define RENDER_TILE 4
+#endif
+
+// most dirty tiles of a row that are composed and sent together
+#ifndef RENDER_RUN
+    #define RENDER_RUN 8
+#endif
+
+// set to 1 to keep a 2 bit per pixel shadow of the sprite color on every panel pixel
+// when drawing directly (RENDER_TILED 0): a moving sprite only blacks out the
+// pixels its new position does not cover and skips the pixels still in its color
+#ifndef RENDER_SHADOW
+    #define RENDER_SHADOW 1
+#endif
+
+// set to 1 to draw whole enemies and bullets with the compiled sprite routines
+// of sprites.c when drawing directly without the shadow (RENDER_TILED 0 and
+// RENDER_SHADOW 0), sprites that reach over the screen edge use the pixel path
+#ifndef RENDER_COMPILED
+    #define RENDER_COMPILED 1
+#endif
+
+// number of entity redraws done, and skipped because the entity did not change
+typedef struct {
+	unsigned int redrawn;
+	unsigned int skipped;
+} renderstats_t;
+
+extern renderstats_t renderStats;
+
+// draw (draw = 1) or erase (draw = 0) a single sprite, with RENDER_TILED both
+// only mark the tiles under the sprite for the next composeFrame
+void drawEnemy(point_t point, int draw);
+void drawBullet(point_t point, int draw);
+void drawPlayer(int draw);
+
+// draw one frame of the game screen and do the collision detection
+void renderFrame(void);
+
+#if RENDER_TILED
+// redraw the marked tiles from the current game state, called by renderFrame
+void composeFrame(void);
+#endif
+
+// forget the sprites drawn so far, for a screen that was cleared to black
+void renderReset(void);
+
+// replace the game screen by the game over screen with the final score, the
+// screen is cleared by the GLCD_ClearStep calls that follow and the text is
+// drawn by the step that finishes the clear
+void renderGameOver(void);
+
+#endif /* _RENDER_H */
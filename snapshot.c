@@ -0,0 +1,279 @@
+#include <stdint.h>
+#include <stddef.h>
+#include "game.h"
+#include "snapshot.h"
+
+/*
+ Snapshot layout, all values little endian:
+   0  'S' 'N' version gameState
+   4  kills (u16) lives (s8) difficulty (u8)
+   8  spawnCount (u32)
+  12  rngState (u32)
+  16  player_angle prev_player_angle (s16 each, binary angle units)
+  20  enemyCount liveEnemies bulletCount liveBullets (u8 each)
+  24  enemy slots 0..enemyCount: point.x point.y prevPoint.x prevPoint.y (s16 each)
+      bullet slots 0..bulletCount: same as enemies, followed by dx dy (s16 Q15) if the bullet is live
+      enemy free list: count (u8) then the indices in list order (u8 each)
+      bullet free list: same as the enemy free list
+      fletcher-16 checksum of everything before it (u16)
+ Dead entities have their point stored as SNAPSHOT_DEAD. The enemy dx/dy are not stored
+ since moveEnemy recomputes them from the position before using them.
+*/
+
+#define SNAPSHOT_DEAD 0x7FFF
+
+static unsigned char *wrPtr;
+static unsigned char *wrEnd;
+static const unsigned char *rdPtr;
+static const unsigned char *rdEnd;
+
+static int put8(uint32_t val){
+	if (wrPtr >= wrEnd) {
+		return 0;
+	}
+	*wrPtr++ = (unsigned char)val;
+	return 1;
+}
+
+static int put16(uint32_t val){
+	return put8(val) && put8(val >> 8);
+}
+
+static int put32(uint32_t val){
+	return put16(val) && put16(val >> 16);
+}
+
+static int putCoord(int32_t val){
+	// coordinates have to fit into a signed 16 bit value
+	if (val < -32768 || val >= SNAPSHOT_DEAD) {
+		return 0;
+	}
+	return put16((uint32_t)val);
+}
+
+static int putPoints(point_t point, point_t prevPoint){
+	int ok;
+	if (point.x == DEADPOINTLOC || point.y == DEADPOINTLOC) {
+		ok = put16(SNAPSHOT_DEAD) && put16(SNAPSHOT_DEAD);
+	} else {
+		ok = putCoord(point.x) && putCoord(point.y);
+	}
+	return ok && putCoord(prevPoint.x) && putCoord(prevPoint.y);
+}
+
+static int putQueue(node_t *head, int max){
+	// store the free list in list order, the count is patched once the list has been walked
+	unsigned char *countPtr = wrPtr;
+	int count = 0;
+	if (!put8(0)) {
+		return 0;
+	}
+	while (head != NULL) {
+		if (count == max || !put8(head->val)) {
+			return 0;
+		}
+		count++;
+		head = head->next;
+	}
+	*countPtr = count;
+	return 1;
+}
+
+static uint32_t get8(void){
+	return rdPtr < rdEnd ? *rdPtr++ : 0;
+}
+
+static uint32_t get16(void){
+	uint32_t val = get8();
+	return val | (get8() << 8);
+}
+
+static uint32_t get32(void){
+	uint32_t val = get16();
+	return val | (get16() << 16);
+}
+
+static int32_t getCoord(void){
+	return (int16_t)get16();
+}
+
+static int getPoints(point_t *point, point_t *prevPoint){
+	// reads the point and previous point of an entity, returns 1 if the entity is live
+	int live;
+	point->x = getCoord();
+	point->y = getCoord();
+	live = !(point->x == SNAPSHOT_DEAD && point->y == SNAPSHOT_DEAD);
+	if (!live) {
+		point->x = DEADPOINTLOC;
+		point->y = DEADPOINTLOC;
+	}
+	prevPoint->x = getCoord();
+	prevPoint->y = getCoord();
+	return live;
+}
+
+static int skipQueue(int max){
+	// checks a stored free list and steps over it
+	int count;
+	int i;
+	if (rdPtr >= rdEnd) {
+		return 0;
+	}
+	count = get8();
+	if (count > max || rdPtr + count > rdEnd) {
+		return 0;
+	}
+	for (i = 0; i < count; i++) {
+		if (get8() >= (uint32_t)max) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static void getQueue(node_t **head){
+	// empty the current free list, then rebuild it so the list order matches the stored one
+	int count;
+	int i;
+	while (dequeue(head) != -1);
+	count = get8();
+	for (i = count - 1; i >= 0; i--) {
+		enqueue(head, rdPtr[i]);
+	}
+	rdPtr += count;
+}
+
+static uint32_t fletcher16(const unsigned char *data, unsigned int len){
+	uint32_t sum1 = 0;
+	uint32_t sum2 = 0;
+	while (len--) {
+		sum1 = (sum1 + *data++) % 255;
+		sum2 = (sum2 + sum1) % 255;
+	}
+	return (sum2 << 8) | sum1;
+}
+
+static int slotCount(int count, int max){
+	// the arrays are used from index 0 up to and including the count
+	return count + 1 < max ? count + 1 : max;
+}
+
+unsigned int saveSnapshot(unsigned char *buf, unsigned int size){
+	int i;
+	int ok;
+	int enemySlots = slotCount(enemyCount, MAX_ENEMIES);
+	int bulletSlots = slotCount(bulletCount, MAX_BULLETS);
+
+	wrPtr = buf;
+	wrEnd = buf + size;
+
+	ok = put8('S') && put8('N') && put8(SNAPSHOT_VERSION) && put8(gameState);
+	ok = ok && kills >= 0 && kills <= 0xFFFF && put16(kills);
+	ok = ok && put8((uint32_t)lives) && put8(difficulty);
+	ok = ok && put32(spawnCount) && put32(rngState);
+	ok = ok && put16((uint16_t)player_angle) && put16((uint16_t)prev_player_angle);
+	ok = ok && put8(enemyCount) && put8(liveEnemies) && put8(bulletCount) && put8(liveBullets);
+
+	for (i = 0; ok && i < enemySlots; i++) {
+		ok = putPoints(enemies[i].point, enemies[i].prevPoint);
+	}
+	for (i = 0; ok && i < bulletSlots; i++) {
+		ok = putPoints(bullets[i].point, bullets[i].prevPoint);
+		if (ok && !(bullets[i].point.x == DEADPOINTLOC || bullets[i].point.y == DEADPOINTLOC)) {
+			ok = put16((uint16_t)bullets[i].dx) && put16((uint16_t)bullets[i].dy);
+		}
+	}
+	ok = ok && putQueue(enemyIndexHead, MAX_ENEMIES) && putQueue(bulletIndexHead, MAX_BULLETS);
+	ok = ok && put16(fletcher16(buf, wrPtr - buf));
+
+	return ok ? wrPtr - buf : 0;
+}
+
+int loadSnapshot(const unsigned char *buf, unsigned int size){
+	int i;
+	int enemySlots;
+	int bulletSlots;
+	point_t point;
+	point_t prevPoint;
+
+	// validate the whole blob before touching any of the game state
+	if (size < SNAPSHOT_HEADER_SIZE + 2 || size > SNAPSHOT_MAX_SIZE) {
+		return 0;
+	}
+	if (buf[0] != 'S' || buf[1] != 'N' || buf[2] != SNAPSHOT_VERSION) {
+		return 0;
+	}
+	if (fletcher16(buf, size - 2) != (uint32_t)(buf[size - 2] | (buf[size - 1] << 8))) {
+		return 0;
+	}
+	enemySlots = slotCount(buf[20], MAX_ENEMIES);
+	bulletSlots = slotCount(buf[22], MAX_BULLETS);
+	if (buf[20] > MAX_ENEMIES || buf[22] > MAX_BULLETS) {
+		return 0;
+	}
+	// the difficulty goes up by one every 5 kills from 1
+	if (buf[3] > GameScreen || (int8_t)buf[6] < 0 || (int8_t)buf[6] > START_LIVES ||
+	    buf[7] < 1 || buf[7] > 1 + (buf[4] | (buf[5] << 8)) / 5) {
+		return 0;
+	}
+	rdPtr = buf + SNAPSHOT_HEADER_SIZE;
+	rdEnd = buf + size - 2;
+	rdPtr += enemySlots * 8;
+	for (i = 0; i < bulletSlots; i++) {
+		if (getPoints(&point, &prevPoint)) {
+			rdPtr += 4;
+		}
+	}
+	if (rdPtr > rdEnd || !skipQueue(MAX_ENEMIES) || !skipQueue(MAX_BULLETS)) {
+		return 0;
+	}
+	if (rdPtr != rdEnd) {
+		return 0;
+	}
+
+	// the blob is valid, restore the state
+	rdPtr = buf + 3;
+	gameState = (State)get8();
+	kills = get16();
+	lives = (int8_t)get8();
+	difficulty = get8();
+	spawnCount = get32();
+	rngState = get32();
+	player_angle = (int16_t)get16();
+	prev_player_angle = (int16_t)get16();
+	//the screen does not show the restored state yet
+	playerDirty = 1;
+	enemyCount = get8();
+	liveEnemies = get8();
+	bulletCount = get8();
+	liveBullets = get8();
+
+	for (i = 0; i < MAX_ENEMIES; i++) {
+		if (i < enemySlots) {
+			getPoints(&enemies[i].point, &enemies[i].prevPoint);
+		} else {
+			enemies[i].point.x = enemies[i].point.y = 0;
+			enemies[i].prevPoint.x = enemies[i].prevPoint.y = 0;
+		}
+		enemies[i].dx = 0;
+		enemies[i].dy = 0;
+		enemies[i].dirty = 1;
+	}
+	for (i = 0; i < MAX_BULLETS; i++) {
+		bullets[i].dx = 0;
+		bullets[i].dy = 0;
+		bullets[i].dirty = 1;
+		if (i < bulletSlots) {
+			if (getPoints(&bullets[i].point, &bullets[i].prevPoint)) {
+				bullets[i].dx = (int16_t)get16();
+				bullets[i].dy = (int16_t)get16();
+			}
+		} else {
+			bullets[i].point.x = bullets[i].point.y = 0;
+			bullets[i].prevPoint.x = bullets[i].prevPoint.y = 0;
+		}
+	}
+	getQueue(&enemyIndexHead);
+	getQueue(&bulletIndexHead);
+	return 1;
+}
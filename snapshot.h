@@ -0,0 +1,20 @@
+#ifndef _SNAPSHOT_H
+#define _SNAPSHOT_H
+
+#include <stdint.h>
+#include "game.h"
+
+#define SNAPSHOT_VERSION 2
+
+// worst case blob size: header, every enemy and bullet slot live, both free lists full
+#define SNAPSHOT_HEADER_SIZE 24
+#define SNAPSHOT_MAX_SIZE (SNAPSHOT_HEADER_SIZE + MAX_ENEMIES*8 + MAX_BULLETS*12 + 2 + MAX_ENEMIES + MAX_BULLETS + 2)
+
+// serialize the game state into buf, returns the number of bytes written or 0 if buf is too small
+unsigned int saveSnapshot(unsigned char *buf, unsigned int size);
+
+// restore the game state from buf, returns 1 on success or 0 if the blob is invalid
+// the game state is left untouched when the blob is rejected
+int loadSnapshot(const unsigned char *buf, unsigned int size);
+
+#endif /* _SNAPSHOT_H */
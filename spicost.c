@@ -0,0 +1,172 @@
+#include <lpc17xx.h>
+#include <stdio.h>
+#include "GLCD.h"
+#include "sprites.h"
+#include "spicost.h"
+#include "target.h"
+
+// number of register writes timed by the calibration
+#define CALIBRATE_WRITES 1000
+
+// number of draws of each sprite timed by the sprite benchmark, at the screen centre
+#define BENCHMARK_DRAWS 100
+#define BENCHMARK_X     160
+#define BENCHMARK_Y     120
+
+// GLCD_Stats counts bytes, a 16 bit pixel frame counts as two, so every counted
+// byte is 8 bit times whatever data size SSP1 is set to
+#define BYTE_BITS 8
+
+// defaults match GLCD_Init at 100 MHz: PCLK = CCLK/2, CPSR = 2, SCR = 1
+spicost_t spiCost = { 100000000, 8, SPICOST_BYTE_CYCLES, SPICOST_START_CYCLES, SPICOST_CS_CYCLES };
+
+void spiCostInit(void){
+	unsigned int pclkDiv;
+	unsigned int scr;
+
+	//the SSP1 peripheral clock is selected by bits 21:20 of PCLKSEL0
+	switch ((LPC_SC->PCLKSEL0 >> 20) & 3) {
+		case 0:  pclkDiv = 4; break;
+		case 1:  pclkDiv = 1; break;
+		case 2:  pclkDiv = 2; break;
+		default: pclkDiv = 8; break;
+	}
+	//the bit rate is PCLK / (CPSR * (SCR + 1))
+	scr = (LPC_SSP1->CR0 >> 8) & 0xFF;
+	spiCost.coreClock = SystemCoreClock;
+	spiCost.bitCycles = pclkDiv * (LPC_SSP1->CPSR & 0xFF) * (scr + 1);
+}
+
+unsigned long spiCostCycles(const GLCD_STATS_T *from, const GLCD_STATS_T *to){
+	unsigned long bytes = to->bytes - from->bytes;
+	unsigned long starts = to->starts - from->starts;
+	unsigned long cs = to->cs - from->cs;
+
+	return bytes * (BYTE_BITS * spiCost.bitCycles + spiCost.byteCycles)
+	     + starts * spiCost.startCycles
+	     + cs * spiCost.csCycles;
+}
+
+unsigned long spiCostMicros(const GLCD_STATS_T *from, const GLCD_STATS_T *to){
+	return spiCostCycles(from, to) / (spiCost.coreClock / 1000000);
+}
+
+void spiCostCalibrate(void){
+#ifndef HOST_BUILD
+	GLCD_STATS_T s0, s1, s2;
+	unsigned int c0, c1, c2;
+	double b1, n1, r1, b2, n2, r2, det, x, y;
+	int i;
+
+	spiCostInit();
+	//only differences are taken, the counter keeps running for the start up time of main.c
+	DEMCR |= DEMCR_TRCENA;
+	DWT_CTRL |= 1;
+
+	//a full screen clear is almost only pixel data bytes
+	s0 = GLCD_Stats;
+	c0 = DWT_CYCCNT;
+	GLCD_Clear(Black);
+	c1 = DWT_CYCCNT;
+	s1 = GLCD_Stats;
+	//register writes are dominated by the start bytes and the chip select toggles
+	for (i = 0; i < CALIBRATE_WRITES; i++) {
+		GLCD_WrReg(0x20, 0);
+	}
+	c2 = DWT_CYCCNT;
+	s2 = GLCD_Stats;
+
+	//take off the shift time and the chip select toggles, then solve
+	//  rest = bytes * byteCycles + starts * startCycles
+	//for both runs
+	b1 = s1.bytes - s0.bytes;
+	n1 = s1.starts - s0.starts;
+	r1 = (double)(c1 - c0) - b1 * BYTE_BITS * spiCost.bitCycles - (double)(s1.cs - s0.cs) * spiCost.csCycles;
+	b2 = s2.bytes - s1.bytes;
+	n2 = s2.starts - s1.starts;
+	r2 = (double)(c2 - c1) - b2 * BYTE_BITS * spiCost.bitCycles - (double)(s2.cs - s1.cs) * spiCost.csCycles;
+	det = b1 * n2 - b2 * n1;
+	if (det == 0 || s1.bytes == s0.bytes) {
+		printf("\nspiCostCalibrate: no traffic counted, build the GLCD driver with GLCD_STATS=1\n");
+		return;
+	}
+	x = (r1 * n2 - r2 * n1) / det;
+	y = (b1 * r2 - b2 * r1) / det;
+	spiCost.byteCycles = x > 0 ? (unsigned int)(x + 0.5) : 0;
+	spiCost.startCycles = y > 0 ? (unsigned int)(y + 0.5) : 0;
+
+	printf("\nSPI cost calibration, %u cycles per bit\n", spiCost.bitCycles);
+	printf("  clear:  %u bytes %u starts %u cycles\n", s1.bytes - s0.bytes, s1.starts - s0.starts, c1 - c0);
+	//compare between builds with GLCD_FIFO and GLCD_SSP16 on and off
+	printf("  clear:  %.0f bytes/s\n", b1 * spiCost.coreClock / (c1 - c0));
+	printf("  wr_reg: %u bytes %u starts %u cycles\n", s2.bytes - s1.bytes, s2.starts - s1.starts, c2 - c1);
+	printf("#define SPICOST_BYTE_CYCLES %u\n", spiCost.byteCycles);
+	printf("#define SPICOST_START_CYCLES %u\n", spiCost.startCycles);
+#endif
+}
+
+static void pixelDraw(const sprite_t *sprite, int x, int y, unsigned short color){
+	// the generic path, one GLCD_PutPixel per sprite pixel
+	int i;
+	GLCD_SetTextColor(color);
+	for (i = 0; i < sprite->count; i++) {
+		GLCD_PutPixel(sprite->points[i].x + x, sprite->points[i].y + y);
+	}
+}
+
+static void benchmarkSprite(const char *name, const sprite_t *sprite, void (*compiled)(int x, int y, unsigned short color)){
+	GLCD_STATS_T s0, s1, s2;
+#ifndef HOST_BUILD
+	//the host has no cycle counter, only the predicted cost is printed there
+	unsigned int c0, c1, c2;
+#endif
+	int i;
+
+	s0 = GLCD_Stats;
+#ifndef HOST_BUILD
+	c0 = DWT_CYCCNT;
+#endif
+	for (i = 0; i < BENCHMARK_DRAWS; i++) {
+		pixelDraw(sprite, BENCHMARK_X, BENCHMARK_Y, (i & 1) ? Black : White);
+	}
+#ifndef HOST_BUILD
+	c1 = DWT_CYCCNT;
+#endif
+	s1 = GLCD_Stats;
+	for (i = 0; i < BENCHMARK_DRAWS; i++) {
+		compiled(BENCHMARK_X, BENCHMARK_Y, (i & 1) ? Black : White);
+	}
+#ifndef HOST_BUILD
+	c2 = DWT_CYCCNT;
+#endif
+	s2 = GLCD_Stats;
+
+	printf("  %-6s pixel loop %4u bytes %6lu cycles", name, (s1.bytes - s0.bytes) / BENCHMARK_DRAWS,
+	       spiCostCycles(&s0, &s1) / BENCHMARK_DRAWS);
+#ifndef HOST_BUILD
+	printf(" (%u measured)", (c1 - c0) / BENCHMARK_DRAWS);
+#endif
+	printf(", compiled %4u bytes %6lu cycles", (s2.bytes - s1.bytes) / BENCHMARK_DRAWS,
+	       spiCostCycles(&s1, &s2) / BENCHMARK_DRAWS);
+#ifndef HOST_BUILD
+	printf(" (%u measured)", (c2 - c1) / BENCHMARK_DRAWS);
+#endif
+	printf("\n");
+}
+
+void spiCostSprites(void){
+	spiCostInit();
+#ifndef HOST_BUILD
+	DEMCR |= DEMCR_TRCENA;
+	DWT_CTRL |= 1;
+#endif
+	GLCD_WindowMax();
+	printf("\nSprite draw cost, predicted by the cost model");
+#ifndef HOST_BUILD
+	printf(" and measured");
+#endif
+	printf("\n");
+	benchmarkSprite("enemy", &enemySprite, enemySpriteDraw);
+	benchmarkSprite("bullet", &bulletSprite, bulletSpriteDraw);
+	GLCD_Clear(Black);
+}
@@ -0,0 +1,46 @@
+#ifndef _SPICOST_H
+#define _SPICOST_H
+
+#include "GLCD.h"
+
+// extra CPU cycles on top of the SSP1 shift time for each byte, each transfer start
+// byte and each chip select toggle, measured with spiCostCalibrate on the board
+#ifndef SPICOST_BYTE_CYCLES
+    #define SPICOST_BYTE_CYCLES 12
+#endif
+#ifndef SPICOST_START_CYCLES
+    #define SPICOST_START_CYCLES 14
+#endif
+#ifndef SPICOST_CS_CYCLES
+    #define SPICOST_CS_CYCLES 4
+#endif
+
+typedef struct {
+	unsigned int coreClock;   // CPU clock in Hz
+	unsigned int bitCycles;   // CPU cycles per SSP1 bit clock
+	unsigned int byteCycles;  // overhead cycles per byte
+	unsigned int startCycles; // overhead cycles per transfer start byte
+	unsigned int csCycles;    // cycles per chip select toggle
+} spicost_t;
+
+extern spicost_t spiCost;
+
+// derive the bit clock from the current SSP1 and PCLK configuration, call after GLCD_Init
+void spiCostInit(void);
+
+// predicted CPU cycles spent on the LCD traffic between two snapshots of GLCD_Stats
+unsigned long spiCostCycles(const GLCD_STATS_T *from, const GLCD_STATS_T *to);
+
+// predicted time in microseconds for the same traffic
+unsigned long spiCostMicros(const GLCD_STATS_T *from, const GLCD_STATS_T *to);
+
+// measure the overhead cycles with the DWT cycle counter and print them, target only,
+// the driver has to be built with GLCD_STATS
+void spiCostCalibrate(void);
+
+// print the cycles per enemy and bullet draw with the GLCD_PutPixel loop and with the
+// compiled sprite routines, measured on the target and predicted by the cost model,
+// the driver has to be built with GLCD_STATS
+void spiCostSprites(void);
+
+#endif /* _SPICOST_H */
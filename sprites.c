@@ -0,0 +1,142 @@
+// generated by host/spritegen.c from sprites.txt, do not edit
+#include "GLCD.h"
+#include "sprites.h"
+
+static const spritepoint_t playerPoints[65] = {
+	{  -8,  -5 }, {  -7,  -5 }, {  -6,  -5 }, {  -5,  -5 }, {  -4,  -5 }, {  -3,  -5 }, {  -2,  -5 }, {  -1,  -5 },
+	{   0,  -5 }, {   1,  -5 }, {   2,  -5 }, {   3,  -5 }, {   4,  -5 }, {   5,  -5 }, {   6,  -5 }, {   7,  -5 },
+	{   8,  -5 }, {  -7,  -4 }, {   7,  -4 }, {  -7,  -3 }, {  -6,  -3 }, {   6,  -3 }, {   7,  -3 }, {  -6,  -2 },
+	{   6,  -2 }, {  -6,  -1 }, {  -5,  -1 }, {   5,  -1 }, {   6,  -1 }, {  -5,   0 }, {   5,   0 }, {  -5,   1 },
+	{  -4,   1 }, {   4,   1 }, {   5,   1 }, {  -4,   2 }, {   4,   2 }, {  -4,   3 }, {  -3,   3 }, {   3,   3 },
+	{   4,   3 }, {  -3,   4 }, {   3,   4 }, {  -3,   5 }, {  -2,   5 }, {   2,   5 }, {   3,   5 }, {  -2,   6 },
+	{   2,   6 }, {  -2,   7 }, {  -1,   7 }, {   1,   7 }, {   2,   7 }, {  -1,   8 }, {   1,   8 }, {  -1,   9 },
+	{   1,   9 }, {  -1,  10 }, {   1,  10 }, {  -1,  11 }, {   1,  11 }, {  -1,  12 }, {   1,  12 }, {  -1,  13 },
+	{   1,  13 }
+};
+static const uint8_t playerRows[20] = {
+	  0,  17,  19,  23,  25,  29,  31,  35,  37,  41,  43,  47,  49,  53,  55,  57,
+	 59,  61,  63,  65
+};
+const sprite_t playerSprite = { playerPoints, playerRows, 65, 13, -5, 19 };
+
+static const spritepoint_t enemyPoints[28] = {
+	{  -2,  -5 }, {  -1,  -5 }, {   0,  -5 }, {   1,  -5 }, {   2,  -5 }, {  -3,  -4 }, {   3,  -4 }, {  -4,  -3 },
+	{   4,  -3 }, {  -5,  -2 }, {   5,  -2 }, {  -5,  -1 }, {   5,  -1 }, {  -5,   0 }, {   5,   0 }, {  -5,   1 },
+	{   5,   1 }, {  -5,   2 }, {   5,   2 }, {  -4,   3 }, {   4,   3 }, {  -3,   4 }, {   3,   4 }, {  -2,   5 },
+	{  -1,   5 }, {   0,   5 }, {   1,   5 }, {   2,   5 }
+};
+static const uint8_t enemyRows[12] = {
+	  0,   5,   7,   9,  11,  13,  15,  17,  19,  21,  23,  28
+};
+const sprite_t enemySprite = { enemyPoints, enemyRows, 28, 5, -5, 11 };
+
+void enemySpriteDraw(int x, int y, unsigned short color){
+	// 28 pixels in 10 row runs and 2 column runs, 260 SPI bytes (376 along the rows only)
+	GLCD_SetCursor(x - 2, y - 5);
+	GLCD_WrCmd(0x22);
+	GLCD_WrDatStart();
+	GLCD_WrDatOnly(color);
+	GLCD_WrDatOnly(color);
+	GLCD_WrDatOnly(color);
+	GLCD_WrDatOnly(color);
+	GLCD_WrDatOnly(color);
+	GLCD_WrDatStop();
+	GLCD_SetCursor(x - 3, y - 4);
+	GLCD_WrCmd(0x22);
+	GLCD_WrDatStart();
+	GLCD_WrDatOnly(color);
+	GLCD_WrDatStop();
+	GLCD_SetCursor(x + 3, y - 4);
+	GLCD_WrCmd(0x22);
+	GLCD_WrDatStart();
+	GLCD_WrDatOnly(color);
+	GLCD_WrDatStop();
+	GLCD_SetCursor(x - 4, y - 3);
+	GLCD_WrCmd(0x22);
+	GLCD_WrDatStart();
+	GLCD_WrDatOnly(color);
+	GLCD_WrDatStop();
+	GLCD_SetCursor(x + 4, y - 3);
+	GLCD_WrCmd(0x22);
+	GLCD_WrDatStart();
+	GLCD_WrDatOnly(color);
+	GLCD_WrDatStop();
+	GLCD_SetCursor(x - 4, y + 3);
+	GLCD_WrCmd(0x22);
+	GLCD_WrDatStart();
+	GLCD_WrDatOnly(color);
+	GLCD_WrDatStop();
+	GLCD_SetCursor(x + 4, y + 3);
+	GLCD_WrCmd(0x22);
+	GLCD_WrDatStart();
+	GLCD_WrDatOnly(color);
+	GLCD_WrDatStop();
+	GLCD_SetCursor(x - 3, y + 4);
+	GLCD_WrCmd(0x22);
+	GLCD_WrDatStart();
+	GLCD_WrDatOnly(color);
+	GLCD_WrDatStop();
+	GLCD_SetCursor(x + 3, y + 4);
+	GLCD_WrCmd(0x22);
+	GLCD_WrDatStart();
+	GLCD_WrDatOnly(color);
+	GLCD_WrDatStop();
+	GLCD_SetCursor(x - 2, y + 5);
+	GLCD_WrCmd(0x22);
+	GLCD_WrDatStart();
+	GLCD_WrDatOnly(color);
+	GLCD_WrDatOnly(color);
+	GLCD_WrDatOnly(color);
+	GLCD_WrDatOnly(color);
+	GLCD_WrDatOnly(color);
+	GLCD_WrDatStop();
+	GLCD_SetVertical(1);
+	GLCD_SetCursor(x - 5, y - 2);
+	GLCD_WrCmd(0x22);
+	GLCD_WrDatStart();
+	GLCD_WrDatOnly(color);
+	GLCD_WrDatOnly(color);
+	GLCD_WrDatOnly(color);
+	GLCD_WrDatOnly(color);
+	GLCD_WrDatOnly(color);
+	GLCD_WrDatStop();
+	GLCD_SetCursor(x + 5, y - 2);
+	GLCD_WrCmd(0x22);
+	GLCD_WrDatStart();
+	GLCD_WrDatOnly(color);
+	GLCD_WrDatOnly(color);
+	GLCD_WrDatOnly(color);
+	GLCD_WrDatOnly(color);
+	GLCD_WrDatOnly(color);
+	GLCD_WrDatStop();
+	GLCD_SetVertical(0);
+}
+
+static const spritepoint_t bulletPoints[5] = {
+	{   0,  -1 }, {  -1,   0 }, {   0,   0 }, {   1,   0 }, {   0,   1 }
+};
+static const uint8_t bulletRows[4] = {
+	  0,   1,   4,   5
+};
+const sprite_t bulletSprite = { bulletPoints, bulletRows, 5, 1, -1, 3 };
+
+void bulletSpriteDraw(int x, int y, unsigned short color){
+	// 5 pixels in 3 row runs and 0 column runs, 58 SPI bytes (58 along the rows only)
+	GLCD_SetCursor(x, y - 1);
+	GLCD_WrCmd(0x22);
+	GLCD_WrDatStart();
+	GLCD_WrDatOnly(color);
+	GLCD_WrDatStop();
+	GLCD_SetCursor(x - 1, y);
+	GLCD_WrCmd(0x22);
+	GLCD_WrDatStart();
+	GLCD_WrDatOnly(color);
+	GLCD_WrDatOnly(color);
+	GLCD_WrDatOnly(color);
+	GLCD_WrDatStop();
+	GLCD_SetCursor(x, y + 1);
+	GLCD_WrCmd(0x22);
+	GLCD_WrDatStart();
+	GLCD_WrDatOnly(color);
+	GLCD_WrDatStop();
+}
@@ -0,0 +1,37 @@
+// generated by host/spritegen.c from sprites.txt, do not edit
+#ifndef _SPRITES_H
+#define _SPRITES_H
+
+#include <stdint.h>
+
+// offset of a sprite pixel from the sprite centre
+typedef struct {
+	int8_t x;
+	int8_t y;
+} spritepoint_t;
+
+// the pixels of a sprite row after row from the top left, none is further than
+// radius from the centre in x or y, the points of row r (y = top + r) are
+// points[rowStart[r]] up to but not including points[rowStart[r + 1]]
+typedef struct {
+	const spritepoint_t *points;
+	const uint8_t *rowStart;
+	uint8_t count;
+	uint8_t radius;
+	int8_t top;
+	uint8_t rows;
+} sprite_t;
+
+// most pixels of any sprite
+#define SPRITE_MAX_POINTS 65
+
+extern const sprite_t playerSprite;
+extern const sprite_t enemySprite;
+extern const sprite_t bulletSprite;
+
+// draw a compiled sprite centered at (x, y) in one color, the whole sprite has to
+// be on the screen and the draw window has to be the whole screen
+void enemySpriteDraw(int x, int y, unsigned short color);
+void bulletSpriteDraw(int x, int y, unsigned short color);
+
+#endif /* _SPRITES_H */
@@ -0,0 +1,20 @@
+#ifndef _TARGET_H
+#define _TARGET_H
+
+#include <lpc17xx.h>
+
+// DWT cycle counter of the Cortex-M3, GLCD_Init starts it for the driver delays
+#define DEMCR        (*(volatile unsigned int *)0xE000EDFC)
+#define DWT_CTRL     (*(volatile unsigned int *)0xE0001000)
+#define DWT_CYCCNT   (*(volatile unsigned int *)0xE0001004)
+#define DEMCR_TRCENA (1 << 24)
+
+// puts a zero initialised variable in the 32 KB AHB SRAM at 0x2007C000 (the RW_IRAM2
+// region of Project2.sct) instead of the CPU local SRAM, which the GPDMA cannot read
+#ifndef HOST_BUILD
+    #define AHBSRAM __attribute__((section("AHBSRAM"), zero_init))
+#else
+    #define AHBSRAM
+#endif
+
+#endif /* _TARGET_H */
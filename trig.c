@@ -0,0 +1,140 @@
+#include <stdint.h>
+#include "trig.h"
+
+// sin(2*pi*i/1024) * 32767, rounded
+//   python: [round(32767*math.sin(2*math.pi*i/1024)) for i in range(1024)]
+const int16_t sinTable[ANGLE_STEPS] = {
+	     0,    201,    402,    603,    804,   1005,   1206,   1407,   1608,   1809,   2009,   2210,
+	  2410,   2611,   2811,   3012,   3212,   3412,   3612,   3811,   4011,   4210,   4410,   4609,
+	  4808,   5007,   5205,   5404,   5602,   5800,   5998,   6195,   6393,   6590,   6786,   6983,
+	  7179,   7375,   7571,   7767,   7962,   8157,   8351,   8545,   8739,   8933,   9126,   9319,
+	  9512,   9704,   9896,  10087,  10278,  10469,  10659,  10849,  11039,  11228,  11417,  11605,
+	 11793,  11980,  12167,  12353,  12539,  12725,  12910,  13094,  13279,  13462,  13645,  13828,
+	 14010,  14191,  14372,  14553,  14732,  14912,  15090,  15269,  15446,  15623,  15800,  15976,
+	 16151,  16325,  16499,  16673,  16846,  17018,  17189,  17360,  17530,  17700,  17869,  18037,
+	 18204,  18371,  18537,  18703,  18868,  19032,  19195,  19357,  19519,  19680,  19841,  20000,
+	 20159,  20317,  20475,  20631,  20787,  20942,  21096,  21250,  21403,  21554,  21705,  21856,
+	 22005,  22154,  22301,  22448,  22594,  22739,  22884,  23027,  23170,  23311,  23452,  23592,
+	 23731,  23870,  24007,  24143,  24279,  24413,  24547,  24680,  24811,  24942,  25072,  25201,
+	 25329,  25456,  25582,  25708,  25832,  25955,  26077,  26198,  26319,  26438,  26556,  26674,
+	 26790,  26905,  27019,  27133,  27245,  27356,  27466,  27575,  27683,  27790,  27896,  28001,
+	 28105,  28208,  28310,  28411,  28510,  28609,  28706,  28803,  28898,  28992,  29085,  29177,
+	 29268,  29358,  29447,  29534,  29621,  29706,  29791,  29874,  29956,  30037,  30117,  30195,
+	 30273,  30349,  30424,  30498,  30571,  30643,  30714,  30783,  30852,  30919,  30985,  31050,
+	 31113,  31176,  31237,  31297,  31356,  31414,  31470,  31526,  31580,  31633,  31685,  31736,
+	 31785,  31833,  31880,  31926,  31971,  32014,  32057,  32098,  32137,  32176,  32213,  32250,
+	 32285,  32318,  32351,  32382,  32412,  32441,  32469,  32495,  32521,  32545,  32567,  32589,
+	 32609,  32628,  32646,  32663,  32678,  32692,  32705,  32717,  32728,  32737,  32745,  32752,
+	 32757,  32761,  32765,  32766,  32767,  32766,  32765,  32761,  32757,  32752,  32745,  32737,
+	 32728,  32717,  32705,  32692,  32678,  32663,  32646,  32628,  32609,  32589,  32567,  32545,
+	 32521,  32495,  32469,  32441,  32412,  32382,  32351,  32318,  32285,  32250,  32213,  32176,
+	 32137,  32098,  32057,  32014,  31971,  31926,  31880,  31833,  31785,  31736,  31685,  31633,
+	 31580,  31526,  31470,  31414,  31356,  31297,  31237,  31176,  31113,  31050,  30985,  30919,
+	 30852,  30783,  30714,  30643,  30571,  30498,  30424,  30349,  30273,  30195,  30117,  30037,
+	 29956,  29874,  29791,  29706,  29621,  29534,  29447,  29358,  29268,  29177,  29085,  28992,
+	 28898,  28803,  28706,  28609,  28510,  28411,  28310,  28208,  28105,  28001,  27896,  27790,
+	 27683,  27575,  27466,  27356,  27245,  27133,  27019,  26905,  26790,  26674,  26556,  26438,
+	 26319,  26198,  26077,  25955,  25832,  25708,  25582,  25456,  25329,  25201,  25072,  24942,
+	 24811,  24680,  24547,  24413,  24279,  24143,  24007,  23870,  23731,  23592,  23452,  23311,
+	 23170,  23027,  22884,  22739,  22594,  22448,  22301,  22154,  22005,  21856,  21705,  21554,
+	 21403,  21250,  21096,  20942,  20787,  20631,  20475,  20317,  20159,  20000,  19841,  19680,
+	 19519,  19357,  19195,  19032,  18868,  18703,  18537,  18371,  18204,  18037,  17869,  17700,
+	 17530,  17360,  17189,  17018,  16846,  16673,  16499,  16325,  16151,  15976,  15800,  15623,
+	 15446,  15269,  15090,  14912,  14732,  14553,  14372,  14191,  14010,  13828,  13645,  13462,
+	 13279,  13094,  12910,  12725,  12539,  12353,  12167,  11980,  11793,  11605,  11417,  11228,
+	 11039,  10849,  10659,  10469,  10278,  10087,   9896,   9704,   9512,   9319,   9126,   8933,
+	  8739,   8545,   8351,   8157,   7962,   7767,   7571,   7375,   7179,   6983,   6786,   6590,
+	  6393,   6195,   5998,   5800,   5602,   5404,   5205,   5007,   4808,   4609,   4410,   4210,
+	  4011,   3811,   3612,   3412,   3212,   3012,   2811,   2611,   2410,   2210,   2009,   1809,
+	  1608,   1407,   1206,   1005,    804,    603,    402,    201,      0,   -201,   -402,   -603,
+	  -804,  -1005,  -1206,  -1407,  -1608,  -1809,  -2009,  -2210,  -2410,  -2611,  -2811,  -3012,
+	 -3212,  -3412,  -3612,  -3811,  -4011,  -4210,  -4410,  -4609,  -4808,  -5007,  -5205,  -5404,
+	 -5602,  -5800,  -5998,  -6195,  -6393,  -6590,  -6786,  -6983,  -7179,  -7375,  -7571,  -7767,
+	 -7962,  -8157,  -8351,  -8545,  -8739,  -8933,  -9126,  -9319,  -9512,  -9704,  -9896, -10087,
+	-10278, -10469, -10659, -10849, -11039, -11228, -11417, -11605, -11793, -11980, -12167, -12353,
+	-12539, -12725, -12910, -13094, -13279, -13462, -13645, -13828, -14010, -14191, -14372, -14553,
+	-14732, -14912, -15090, -15269, -15446, -15623, -15800, -15976, -16151, -16325, -16499, -16673,
+	-16846, -17018, -17189, -17360, -17530, -17700, -17869, -18037, -18204, -18371, -18537, -18703,
+	-18868, -19032, -19195, -19357, -19519, -19680, -19841, -20000, -20159, -20317, -20475, -20631,
+	-20787, -20942, -21096, -21250, -21403, -21554, -21705, -21856, -22005, -22154, -22301, -22448,
+	-22594, -22739, -22884, -23027, -23170, -23311, -23452, -23592, -23731, -23870, -24007, -24143,
+	-24279, -24413, -24547, -24680, -24811, -24942, -25072, -25201, -25329, -25456, -25582, -25708,
+	-25832, -25955, -26077, -26198, -26319, -26438, -26556, -26674, -26790, -26905, -27019, -27133,
+	-27245, -27356, -27466, -27575, -27683, -27790, -27896, -28001, -28105, -28208, -28310, -28411,
+	-28510, -28609, -28706, -28803, -28898, -28992, -29085, -29177, -29268, -29358, -29447, -29534,
+	-29621, -29706, -29791, -29874, -29956, -30037, -30117, -30195, -30273, -30349, -30424, -30498,
+	-30571, -30643, -30714, -30783, -30852, -30919, -30985, -31050, -31113, -31176, -31237, -31297,
+	-31356, -31414, -31470, -31526, -31580, -31633, -31685, -31736, -31785, -31833, -31880, -31926,
+	-31971, -32014, -32057, -32098, -32137, -32176, -32213, -32250, -32285, -32318, -32351, -32382,
+	-32412, -32441, -32469, -32495, -32521, -32545, -32567, -32589, -32609, -32628, -32646, -32663,
+	-32678, -32692, -32705, -32717, -32728, -32737, -32745, -32752, -32757, -32761, -32765, -32766,
+	-32767, -32766, -32765, -32761, -32757, -32752, -32745, -32737, -32728, -32717, -32705, -32692,
+	-32678, -32663, -32646, -32628, -32609, -32589, -32567, -32545, -32521, -32495, -32469, -32441,
+	-32412, -32382, -32351, -32318, -32285, -32250, -32213, -32176, -32137, -32098, -32057, -32014,
+	-31971, -31926, -31880, -31833, -31785, -31736, -31685, -31633, -31580, -31526, -31470, -31414,
+	-31356, -31297, -31237, -31176, -31113, -31050, -30985, -30919, -30852, -30783, -30714, -30643,
+	-30571, -30498, -30424, -30349, -30273, -30195, -30117, -30037, -29956, -29874, -29791, -29706,
+	-29621, -29534, -29447, -29358, -29268, -29177, -29085, -28992, -28898, -28803, -28706, -28609,
+	-28510, -28411, -28310, -28208, -28105, -28001, -27896, -27790, -27683, -27575, -27466, -27356,
+	-27245, -27133, -27019, -26905, -26790, -26674, -26556, -26438, -26319, -26198, -26077, -25955,
+	-25832, -25708, -25582, -25456, -25329, -25201, -25072, -24942, -24811, -24680, -24547, -24413,
+	-24279, -24143, -24007, -23870, -23731, -23592, -23452, -23311, -23170, -23027, -22884, -22739,
+	-22594, -22448, -22301, -22154, -22005, -21856, -21705, -21554, -21403, -21250, -21096, -20942,
+	-20787, -20631, -20475, -20317, -20159, -20000, -19841, -19680, -19519, -19357, -19195, -19032,
+	-18868, -18703, -18537, -18371, -18204, -18037, -17869, -17700, -17530, -17360, -17189, -17018,
+	-16846, -16673, -16499, -16325, -16151, -15976, -15800, -15623, -15446, -15269, -15090, -14912,
+	-14732, -14553, -14372, -14191, -14010, -13828, -13645, -13462, -13279, -13094, -12910, -12725,
+	-12539, -12353, -12167, -11980, -11793, -11605, -11417, -11228, -11039, -10849, -10659, -10469,
+	-10278, -10087,  -9896,  -9704,  -9512,  -9319,  -9126,  -8933,  -8739,  -8545,  -8351,  -8157,
+	 -7962,  -7767,  -7571,  -7375,  -7179,  -6983,  -6786,  -6590,  -6393,  -6195,  -5998,  -5800,
+	 -5602,  -5404,  -5205,  -5007,  -4808,  -4609,  -4410,  -4210,  -4011,  -3811,  -3612,  -3412,
+	 -3212,  -3012,  -2811,  -2611,  -2410,  -2210,  -2009,  -1809,  -1608,  -1407,  -1206,  -1005,
+	  -804,   -603,   -402,   -201
+};
+
+// atan(i/256) in binary angle units, rounded
+//   python: [round(math.atan(i/256)*1024/(2*math.pi)) for i in range(257)]
+static const uint8_t atanTable[257] = {
+	  0,   1,   1,   2,   3,   3,   4,   4,   5,   6,   6,   7,   8,   8,   9,  10,
+	 10,  11,  11,  12,  13,  13,  14,  15,  15,  16,  16,  17,  18,  18,  19,  20,
+	 20,  21,  22,  22,  23,  23,  24,  25,  25,  26,  27,  27,  28,  28,  29,  30,
+	 30,  31,  31,  32,  33,  33,  34,  34,  35,  36,  36,  37,  38,  38,  39,  39,
+	 40,  41,  41,  42,  42,  43,  44,  44,  45,  45,  46,  46,  47,  48,  48,  49,
+	 49,  50,  51,  51,  52,  52,  53,  53,  54,  55,  55,  56,  56,  57,  57,  58,
+	 58,  59,  60,  60,  61,  61,  62,  62,  63,  63,  64,  65,  65,  66,  66,  67,
+	 67,  68,  68,  69,  69,  70,  70,  71,  71,  72,  72,  73,  74,  74,  75,  75,
+	 76,  76,  77,  77,  78,  78,  79,  79,  80,  80,  81,  81,  82,  82,  83,  83,
+	 84,  84,  84,  85,  85,  86,  86,  87,  87,  88,  88,  89,  89,  90,  90,  91,
+	 91,  91,  92,  92,  93,  93,  94,  94,  95,  95,  96,  96,  96,  97,  97,  98,
+	 98,  99,  99,  99, 100, 100, 101, 101, 102, 102, 102, 103, 103, 104, 104, 104,
+	105, 105, 106, 106, 106, 107, 107, 108, 108, 108, 109, 109, 110, 110, 110, 111,
+	111, 112, 112, 112, 113, 113, 113, 114, 114, 115, 115, 115, 116, 116, 116, 117,
+	117, 118, 118, 118, 119, 119, 119, 120, 120, 120, 121, 121, 121, 122, 122, 122,
+	123, 123, 123, 124, 124, 124, 125, 125, 125, 126, 126, 126, 127, 127, 127, 128,
+	128
+};
+
+angle_t atan2Angle(int32_t y, int32_t x){
+	// function to return the angle of the vector (x, y), the angle of (1, 0) is 0
+	// and the angle of (0, 1) is ANGLE_STEPS/4
+	int32_t ax = x < 0 ? -x : x;
+	int32_t ay = y < 0 ? -y : y;
+	int a;
+	if (ax == 0 && ay == 0) {
+		return 0;
+	}
+	//first octant from the table, the second one by symmetry about 45 degrees
+	if (ay <= ax) {
+		a = atanTable[(ay * 256 + ax / 2) / ax];
+	} else {
+		a = ANGLE_STEPS/4 - atanTable[(ax * 256 + ay / 2) / ay];
+	}
+	//mirror into the quadrant of (x, y)
+	if (x < 0) {
+		a = ANGLE_STEPS/2 - a;
+	}
+	if (y < 0) {
+		a = -a;
+	}
+	return (angle_t)a;
+}
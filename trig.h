@@ -0,0 +1,22 @@
+#ifndef _TRIG_H
+#define _TRIG_H
+
+#include <stdint.h>
+
+// binary angle units per turn, angles wrap around at ANGLE_STEPS
+#define ANGLE_STEPS 1024
+#define ANGLE_MASK  (ANGLE_STEPS - 1)
+
+// angle in binary units, counter-clockwise from the x axis
+typedef int16_t angle_t;
+
+// sine of the binary angles in Q15, the cosine is the sine a quarter turn later
+extern const int16_t sinTable[ANGLE_STEPS];
+
+#define sinQ15(a) (sinTable[(a) & ANGLE_MASK])
+#define cosQ15(a) (sinTable[((a) + ANGLE_STEPS/4) & ANGLE_MASK])
+
+// angle of the vector (x, y) to within one binary unit, like atan2(y, x)
+angle_t atan2Angle(int32_t y, int32_t x);
+
+#endif /* _TRIG_H */